@@ -9,6 +9,7 @@
 #include "Editor.h"
 #include "SceneManager.h"
 #include "Utilities/Utilities.h"
+#include "Utilities/Profiler.h"
 
 void GLFWErrorCallback(int, const char* err_str)
 {
@@ -39,6 +40,8 @@ void App::Run()
 {
 	while(runApp)
 	{
+		PROFILE_ZONE("Frame");
+
 		Start();
 		Update();
 		Render();
@@ -68,6 +71,7 @@ void App::Render()
 	renderer->Render();
 	editor->Render();
 
+	PROFILE_ZONE("Swap Buffers");
 	glfwSwapBuffers(renderer->GetWindow());
 }
 
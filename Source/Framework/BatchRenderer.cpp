@@ -0,0 +1,346 @@
+#include "BatchRenderer.h"
+
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <stb_image_write.h>
+#include <tinyexr.h>
+
+#include "Graphics/RayTracer.h"
+#include "Graphics/PostProcessor.h"
+#include "Graphics/SurfaceFeatures.h"
+#include "Graphics/TraceStats.h"
+
+#include "Framework/SceneManager.h"
+#include "Framework/WorkerSystem.h"
+#include "Utilities/Utilities.h"
+
+bool ParseBatchArguments(int argc, char** argv, BatchSettings& settings)
+{
+	bool batchRequested = false;
+	bool hasSampleCount = false;
+	bool hasSize = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if(argument == "--batch" && hasValue)
+		{
+			settings.ScenePath = argv[++i];
+			batchRequested = true;
+		}
+		else if(argument == "--spp" && hasValue)
+		{
+			settings.SampleCount = max(atoi(argv[++i]), 1);
+			hasSampleCount = true;
+		}
+		else if(argument == "--size" && i + 2 < argc)
+		{
+			settings.Width = max(atoi(argv[++i]), 1);
+			settings.Height = max(atoi(argv[++i]), 1);
+			hasSize = true;
+		}
+		else if(argument == "--output" && hasValue)
+		{
+			settings.OutputPath = argv[++i];
+		}
+		else if(argument == "--skydome" && hasValue)
+		{
+			settings.SkydomePath = argv[++i];
+		}
+		else if(argument == "--format" && hasValue)
+		{
+			std::string format = argv[++i];
+			settings.WritePNG = format == "png" || format == "all";
+			settings.WriteEXR = format == "exr" || format == "all";
+		}
+		else if(argument == "--denoise")
+		{
+			settings.Denoise = true;
+		}
+		else if(argument == "--adaptive")
+		{
+			settings.AdaptiveSampling = true;
+
+			// The threshold is optional, anything that isn't another argument is taken as one //
+			if(hasValue && argv[i + 1][0] != '-')
+			{
+				settings.AdaptiveThreshold = max((float)atof(argv[++i]), 0.0001f);
+			}
+		}
+		else if(argument == "--heatmap" && hasValue)
+		{
+			std::string mode = argv[++i];
+			settings.Heatmap = mode == "time" ? HeatmapMode::TraceTime :
+				mode == "tests" ? HeatmapMode::IntersectionTests :
+				mode == "length" ? HeatmapMode::PathLength : HeatmapMode::None;
+		}
+		else if(argument == "--profile" && hasValue)
+		{
+			settings.ProfilePath = argv[++i];
+		}
+		else if(argument == "--benchmark")
+		{
+			settings.Benchmark = true;
+			batchRequested = true;
+		}
+		else if(argument == "--threads" && hasValue)
+		{
+			// Comma separated, e.g. '1,4,16' //
+			for(char* count = argv[++i]; *count != '\0'; count++)
+			{
+				int threads = strtol(count, &count, 10);
+				if(threads > 0)
+				{
+					settings.ThreadCounts.push_back(threads);
+				}
+
+				if(*count == '\0')
+				{
+					break;
+				}
+			}
+		}
+		else
+		{
+			LOG(Log::MessageType::Error, "Ignoring unknown or incomplete argument: '" + argument + "'");
+		}
+	}
+
+	// Every reference scene runs once per thread count, so the benchmark defaults to a much lighter load //
+	if(settings.Benchmark)
+	{
+		settings.SampleCount = hasSampleCount ? settings.SampleCount : 16;
+		settings.Width = hasSize ? settings.Width : 640;
+		settings.Height = hasSize ? settings.Height : 360;
+	}
+
+	return batchRequested;
+}
+
+BatchRenderer::BatchRenderer(const BatchSettings& settings) : settings(settings)
+{
+	sceneManager = new SceneManager(settings.ScenePath, settings.SkydomePath, settings.Width, settings.Height);
+	scene = sceneManager->GetActiveScene();
+
+	Initialize();
+}
+
+BatchRenderer::BatchRenderer(const BatchSettings& settings, Scene* scene) : settings(settings), scene(scene)
+{
+	Initialize();
+}
+
+void BatchRenderer::Initialize()
+{
+	// Create Sample Buffers //
+	bufferSize = settings.Width * settings.Height;
+	sampleBuffer = new vec3[bufferSize];
+	halfSampleBuffer = new vec3[bufferSize];
+	snapshotBuffer = new vec3[bufferSize];
+	featureBuffer = new SurfaceFeatures[bufferSize];
+	featureSnapshotBuffer = new SurfaceFeatures[bufferSize];
+
+	targetSampleCount = settings.SampleCount;
+
+	if(scene == nullptr)
+	{
+		return;
+	}
+
+	// The workers start tracing right away, so everything they touch has to exist first //
+	rayTracer = new RayTracer(settings.Width, settings.Height, scene);
+	rayTracer->heatmapMode = settings.Heatmap;
+	workerSystem = new WorkerSystem(this, settings.Width, settings.Height);
+	workerSystem->useAdaptiveSampling = settings.AdaptiveSampling;
+	workerSystem->adaptiveThreshold = settings.AdaptiveThreshold;
+	postProcessor = new PostProcessor(workerSystem, settings.Width, settings.Height);
+	postProcessor->doDenoising = settings.Denoise;
+	postProcessor->showHeatmap = settings.Heatmap != HeatmapMode::None;
+}
+
+BatchRenderer::~BatchRenderer()
+{
+	delete workerSystem;
+	delete postProcessor;
+	delete rayTracer;
+	delete sceneManager;
+
+	delete[] sampleBuffer;
+	delete[] halfSampleBuffer;
+	delete[] snapshotBuffer;
+	delete[] featureBuffer;
+	delete[] featureSnapshotBuffer;
+}
+
+bool BatchRenderer::Render()
+{
+	if(workerSystem == nullptr)
+	{
+		LOG(Log::MessageType::Error, "Batch render cancelled, the scene '" + settings.ScenePath + "' couldn't be loaded!");
+		return false;
+	}
+
+	LOG("Batch rendering '" + settings.ScenePath + "' at " + std::to_string(settings.Width) + "x" +
+		std::to_string(settings.Height) + " with " + std::to_string(settings.SampleCount) + " samples per pixel...");
+
+	auto start = std::chrono::high_resolution_clock::now();
+	TraceSamples(true);
+	auto end = std::chrono::high_resolution_clock::now();
+
+	float seconds = std::chrono::duration<float>(end - start).count();
+	LOG("Traced " + std::to_string(sampleCount) + " samples in " + std::to_string(seconds) + " seconds.");
+
+	if(settings.AdaptiveSampling)
+	{
+		LOG(std::to_string(workerSystem->GetConvergedPercentage()) + "% of the pixels converged early.");
+	}
+
+#if USE_TRACE_STATS
+	TraceStats stats = TraceStats::Gather();
+	LOG("Rays: " + std::to_string(stats.CameraRays) + " camera, " + std::to_string(stats.BounceRays) + " bounce, " +
+		std::to_string(stats.ShadowRays) + " shadow (" + std::to_string(stats.OccludedShadowRays) + " occluded)");
+	LOG("Paths ended by: " + std::to_string(stats.SkyMisses) + " sky misses, " + std::to_string(stats.RussianRouletteTerminations) +
+		" russian roulette, " + std::to_string(stats.MaxDepthTerminations) + " max ray depth");
+	LOG("BVH: " + std::to_string(stats.NodesVisited) + " nodes, " + std::to_string(stats.ShadowNodesVisited) + " shadow nodes, " +
+		std::to_string(stats.SphereTests) + " sphere, " + std::to_string(stats.PlaneTests) + " plane & " +
+		std::to_string(stats.TriangleTests) + " triangle tests");
+#endif
+
+	// Tiles can have a different amount of samples once some of them converged //
+	workerSystem->TakeSnapshot(snapshotBuffer, featureSnapshotBuffer);
+
+	std::string path = settings.OutputPath;
+	if(path.empty())
+	{
+		path = "Screenshots/" + scene->Name + "_" + std::to_string(settings.SampleCount) + "spp";
+	}
+
+	bool succeeded = true;
+
+	if(settings.WritePNG)
+	{
+		succeeded &= WritePNG(path + ".png");
+	}
+
+	if(settings.WriteEXR)
+	{
+		succeeded &= WriteEXR(path + ".exr");
+	}
+
+	return succeeded;
+}
+
+float BatchRenderer::TimeSamples(int threadCount)
+{
+	workerSystem->SetThreadCount(threadCount);
+
+	// Restarting the threads also restarts the iteration, wait for it to get out of the buffers //
+	workerSystem->Pause();
+	workerSystem->useAdaptiveSampling = false;
+
+	sampleCount = 1;
+	memset(sampleBuffer, 0, sizeof(vec3) * bufferSize);
+	memset(halfSampleBuffer, 0, sizeof(vec3) * bufferSize);
+	memset(featureBuffer, 0, sizeof(SurfaceFeatures) * bufferSize);
+	workerSystem->ClearTileSamples();
+	TraceStats::Reset();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	workerSystem->NotifyWorkers();
+	TraceSamples(false);
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<float>(end - start).count();
+}
+
+/// <summary>
+/// Same iteration loop as the windowed renderer, one sample for every pixel at a time,
+/// until either the target sample count is reached or adaptive sampling converged everywhere.
+/// </summary>
+void BatchRenderer::TraceSamples(bool logProgress)
+{
+	int progressStep = max(settings.SampleCount / 10, 1);
+
+	while(true)
+	{
+		workerSystem->WaitForIteration();
+
+		if(logProgress && sampleCount % progressStep == 0)
+		{
+			LOG("Sample " + std::to_string(sampleCount) + " / " + std::to_string(settings.SampleCount));
+		}
+
+		if(sampleCount >= targetSampleCount || workerSystem->IsConverged())
+		{
+			break;
+		}
+
+		sampleCount++;
+		workerSystem->NotifyWorkers();
+	}
+}
+
+/// <summary>
+/// Tonemapped, gamma corrected & optionally denoised, exactly like it would show up on screen.
+/// </summary>
+bool BatchRenderer::WritePNG(const std::string& path)
+{
+	unsigned int* pixels = new unsigned int[bufferSize];
+	postProcessor->PostProcess(snapshotBuffer, featureSnapshotBuffer, 1, pixels);
+
+	for(unsigned int i = 0; i < bufferSize; i++)
+	{
+		pixels[i] |= (255 << 24);
+	}
+
+	// Rows are stored bottom-up, like the OpenGL texture they normally end up in //
+	stbi_flip_vertically_on_write(true);
+	bool succeeded = stbi_write_png(path.c_str(), settings.Width, settings.Height, 4, pixels, settings.Width * sizeof(unsigned int)) != 0;
+	delete[] pixels;
+
+	if(!succeeded)
+	{
+		LOG(Log::MessageType::Error, "Failed to write '" + path + "'");
+		return false;
+	}
+
+	LOG("Written '" + path + "'");
+	return true;
+}
+
+/// <summary>
+/// The averaged radiance as 32-bit floats, before any post-processing.
+/// </summary>
+bool BatchRenderer::WriteEXR(const std::string& path)
+{
+	std::vector<float> pixels(bufferSize * 3);
+
+	for(unsigned int y = 0; y < settings.Height; y++)
+	{
+		// EXR stores rows top-down //
+		const vec3* source = snapshotBuffer + (settings.Height - 1 - y) * settings.Width;
+		float* destination = pixels.data() + y * settings.Width * 3;
+
+		for(unsigned int x = 0; x < settings.Width; x++)
+		{
+			memcpy(destination + x * 3, source[x].data, sizeof(float) * 3);
+		}
+	}
+
+	const char* err = nullptr;
+	int result = SaveEXR(pixels.data(), settings.Width, settings.Height, 3, 0, path.c_str(), &err);
+
+	if(result != TINYEXR_SUCCESS)
+	{
+		LOG(Log::MessageType::Error, "Failed to write '" + path + "': " + (err ? err : "unknown error"));
+		FreeEXRErrorMessage(err);
+		return false;
+	}
+
+	LOG("Written '" + path + "'");
+	return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "Framework/RenderContext.h"
+#include "Graphics/RayTracer.h"
+#include <string>
+#include <vector>
+
+struct Scene;
+class SceneManager;
+class WorkerSystem;
+class PostProcessor;
+
+struct BatchSettings
+{
+	std::string ScenePath;
+	std::string SkydomePath = "Assets/EXRs/studio.exr";
+	std::string OutputPath; // Without extension, defaults to 'Screenshots/<scene>_<samples>spp'
+
+	unsigned int Width = 1280;
+	unsigned int Height = 720;
+	int SampleCount = 256;
+
+	bool WritePNG = true;
+	bool WriteEXR = true;
+	bool Denoise = false;
+	HeatmapMode Heatmap = HeatmapMode::None; // Writes trace costs instead of radiance, see 'HeatmapMode'
+	std::string ProfilePath; // Once done, writes the recorded profiler zones as a Chrome trace to this path
+
+	// Off unless asked for, since converged tiles stop short of 'SampleCount' //
+	bool AdaptiveSampling = false;
+	float AdaptiveThreshold = 0.01f;
+
+	// Benchmarking //
+	// Renders the built-in reference scenes instead, and writes the timings to '<OutputPath>.json'.
+	// Without explicit 'ThreadCounts', runs on 1, 2, 4, ... threads up to every hardware thread.
+	bool Benchmark = false;
+	std::vector<int> ThreadCounts;
+};
+
+// Fills in 'settings' from the command line, returns true if a batch render or benchmark got requested.
+// Usage: --batch <scene> [--spp <count>] [--size <width> <height>] [--output <path>]
+//        [--skydome <exr>] [--format <png|exr|all>] [--denoise] [--adaptive [threshold]] [--heatmap <time|tests|length>] [--profile <json>]
+//        --benchmark [--spp <count>] [--size <width> <height>] [--output <path>] [--threads <count,count,...>] [--profile <json>]
+bool ParseBatchArguments(int argc, char** argv, BatchSettings& settings);
+
+/// <summary>
+/// Renders a scene straight to disk without a window. Only depends on the ray tracer,
+/// the workers & the post-processor, so it also builds without GLFW, OpenGL & ImGui.
+/// </summary>
+class BatchRenderer : public RenderContext
+{
+public:
+	BatchRenderer(const BatchSettings& settings);
+	BatchRenderer(const BatchSettings& settings, Scene* scene); // For scenes built in code, 'scene' stays owned by the caller
+	~BatchRenderer();
+
+	// Traces every sample, then writes the requested images. Returns false if anything failed.
+	bool Render();
+
+	// Starts over from the first sample on 'threadCount' workers without adaptive sampling,
+	// so every run traces the exact same paths. Returns how long tracing took in seconds.
+	float TimeSamples(int threadCount);
+
+private:
+	void Initialize();
+	void TraceSamples(bool logProgress);
+
+	bool WritePNG(const std::string& path);
+	bool WriteEXR(const std::string& path);
+
+private:
+	BatchSettings settings;
+	Scene* scene = nullptr;
+
+	WorkerSystem* workerSystem = nullptr;
+	SceneManager* sceneManager = nullptr;
+	PostProcessor* postProcessor = nullptr;
+
+	unsigned int bufferSize;
+	vec3* snapshotBuffer = nullptr;
+	SurfaceFeatures* featureSnapshotBuffer = nullptr;
+};
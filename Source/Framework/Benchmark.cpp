@@ -0,0 +1,350 @@
+#include "Benchmark.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "Graphics/BVH.h"
+#include "Graphics/Camera.h"
+#include "Graphics/RayTracer.h"
+#include "Graphics/Sphere.h"
+#include "Graphics/PlaneInfinite.h"
+#include "Graphics/Triangle.h"
+#include "Graphics/TraceStats.h"
+
+#include "Framework/BatchRenderer.h"
+#include "Framework/SceneManager.h"
+#include "Utilities/Utilities.h"
+
+// Peak memory, after Windows.h got included through the utilities //
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+struct BenchmarkRun
+{
+	int ThreadCount;
+	float Seconds;
+	TraceStats Stats;
+};
+
+// Reference Scenes //
+// Built in code from a fixed seed, so every machine renders the exact same scenes without any assets.
+
+/// <summary>
+/// Equirectangular gradient with a small, bright sun. Row 0 is straight up, like 'Skydome::GetPixelIndex' expects.
+/// </summary>
+static void CreateSkydome(Skydome& skydome)
+{
+	skydome.Name = "Benchmark";
+	skydome.width = 512;
+	skydome.height = 256;
+	skydome.comp = 4;
+	skydome.image = new float[skydome.width * skydome.height * skydome.comp];
+
+	vec3 zenith = vec3(0.25f, 0.45f, 0.9f);
+	vec3 horizon = vec3(0.9f, 0.85f, 0.8f);
+	vec3 ground = vec3(0.2f);
+
+	for(int y = 0; y < skydome.height; y++)
+	{
+		float up = cosf((y + 0.5f) / skydome.height * PI);
+		vec3 sky = up > 0.0f ? horizon * (1.0f - up) + zenith * up : ground;
+
+		for(int x = 0; x < skydome.width; x++)
+		{
+			bool isSun = x >= 150 && x < 156 && y >= 60 && y < 66;
+			vec3 color = isSun ? vec3(500.0f, 450.0f, 400.0f) : sky;
+
+			float* pixel = &skydome.image[(x + y * skydome.width) * skydome.comp];
+			pixel[0] = color.x;
+			pixel[1] = color.y;
+			pixel[2] = color.z;
+			pixel[3] = 1.0f;
+		}
+	}
+
+	skydome.BuildDistribution();
+}
+
+static Scene* CreateScene(const std::string& name, unsigned int screenWidth, unsigned int screenHeight)
+{
+	Scene* scene = new Scene();
+	scene->Name = name;
+	scene->Camera = new Camera(vec3(0.0f, 1.0f, -4.0f), screenWidth, screenHeight);
+	scene->BVH = new BVH();
+	CreateSkydome(scene->Skydome);
+
+	// Every scene but the skydome one stands on a ground plane //
+	if(name != "skydome-only")
+	{
+		PlaneInfinite* ground = new PlaneInfinite(vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+		ground->Material.Color = vec3(0.5f);
+		scene->primitives.push_back(ground);
+	}
+
+	unsigned int seed = 1;
+
+	if(name == "few-spheres")
+	{
+		Sphere* diffuse = new Sphere(vec3(-1.2f, 0.5f, 0.0f), 0.5f, vec3(0.8f, 0.3f, 0.3f));
+
+		Sphere* glass = new Sphere(vec3(0.0f, 0.5f, 0.0f), 0.5f);
+		glass->Material.isDielectric = true;
+		glass->Material.IoR = 1.5f;
+
+		Sphere* metal = new Sphere(vec3(1.2f, 0.5f, 0.0f), 0.5f, vec3(0.9f, 0.8f, 0.2f));
+		metal->Material.Specularity = 0.3f;
+		metal->Material.Metalness = 0.8f;
+
+		Sphere* light = new Sphere(vec3(0.0f, 3.0f, 0.0f), 0.5f);
+		light->Material.isEmissive = true;
+		light->Material.EmissiveStrength = 5.0f;
+
+		scene->primitives.insert(scene->primitives.end(), { diffuse, glass, metal, light });
+	}
+	else if(name == "many-spheres")
+	{
+		// A 64x64 grid of small spheres, with every tenth one metallic //
+		for(int z = 0; z < 64; z++)
+		{
+			for(int x = 0; x < 64; x++)
+			{
+				vec3 position = vec3(-4.0f + x * 0.125f, 0.05f, z * 0.125f);
+				vec3 color = vec3(Random01(seed), Random01(seed), Random01(seed));
+
+				Sphere* sphere = new Sphere(position, 0.05f, color);
+				sphere->Material.Metalness = Random01(seed) < 0.1f ? 1.0f : 0.0f;
+				scene->primitives.push_back(sphere);
+			}
+		}
+	}
+	else if(name == "glass")
+	{
+		// A 7x7 grid of dielectric spheres, half of them absorbing //
+		for(int z = 0; z < 7; z++)
+		{
+			for(int x = 0; x < 7; x++)
+			{
+				Sphere* sphere = new Sphere(vec3(-2.1f + x * 0.7f, 0.3f, z * 0.7f), 0.3f, vec3(0.9f, 0.95f, 1.0f));
+				sphere->Material.isDielectric = true;
+				sphere->Material.IoR = RandomInRange(1.3f, 1.8f, seed);
+				sphere->Material.Density = (x + z) % 2 == 0 ? 0.5f : 0.0f;
+				scene->primitives.push_back(sphere);
+			}
+		}
+	}
+	else if(name == "triangle-mesh")
+	{
+		// Tessellated sphere of 128 x 64 quads, 16K triangles //
+		const int slices = 128;
+		const int stacks = 64;
+		vec3 center = vec3(0.0f, 1.0f, 1.0f);
+
+		auto vertex = [&](int slice, int stack)
+		{
+			float theta = stack * PI / stacks;
+			float phi = slice * 2.0f * PI / slices;
+			return center + vec3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+		};
+
+		for(int stack = 0; stack < stacks; stack++)
+		{
+			for(int slice = 0; slice < slices; slice++)
+			{
+				vec3 a = vertex(slice, stack);
+				vec3 b = vertex(slice + 1, stack);
+				vec3 c = vertex(slice, stack + 1);
+				vec3 d = vertex(slice + 1, stack + 1);
+
+				Triangle* first = new Triangle(a, b, c);
+				Triangle* second = new Triangle(b, d, c);
+				first->Material.Color = vec3(0.7f);
+				second->Material.Color = vec3(0.7f);
+				scene->primitives.insert(scene->primitives.end(), { first, second });
+			}
+		}
+	}
+
+	scene->BVH->Build(scene->primitives);
+
+	for(Primitive* primitive : scene->primitives)
+	{
+		if(primitive->Material.isEmissive)
+		{
+			scene->EmissivePrimitives.push_back(primitive);
+		}
+	}
+
+	return scene;
+}
+
+static void DeleteScene(Scene* scene)
+{
+	for(Primitive* primitive : scene->primitives)
+	{
+		delete primitive;
+	}
+
+	delete[] scene->Skydome.image;
+	delete scene->Camera;
+	delete scene->BVH;
+	delete scene;
+}
+
+static double GetPeakMemoryMB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+	}
+
+	return 0.0;
+#else
+	// Reported in kilobytes on Linux //
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+static void WriteRun(std::ostream& json, const BenchmarkRun& run, const BenchmarkRun& baseline, int sampleCount, bool isLast)
+{
+	json << "\t\t\t\t{ ";
+	json << "\"threads\": " << run.ThreadCount << ", ";
+	json << "\"seconds\": " << run.Seconds << ", ";
+	json << "\"msPerSample\": " << run.Seconds * 1000.0f / sampleCount << ", ";
+
+	// Without trace statistics there are no rays to count //
+#if USE_TRACE_STATS
+	const TraceStats& stats = run.Stats;
+	unsigned long long secondaryRays = stats.BounceRays + stats.ShadowRays;
+	double megaRaysPerSecond = 1.0 / (run.Seconds * 1000000.0);
+
+	json << "\"primaryRays\": " << stats.CameraRays << ", ";
+	json << "\"bounceRays\": " << stats.BounceRays << ", ";
+	json << "\"shadowRays\": " << stats.ShadowRays << ", ";
+	json << "\"occludedShadowRays\": " << stats.OccludedShadowRays << ", ";
+	json << "\"skyMisses\": " << stats.SkyMisses << ", ";
+	json << "\"russianRouletteTerminations\": " << stats.RussianRouletteTerminations << ", ";
+	json << "\"maxDepthTerminations\": " << stats.MaxDepthTerminations << ", ";
+	json << "\"nodesVisited\": " << stats.NodesVisited << ", ";
+	json << "\"shadowNodesVisited\": " << stats.ShadowNodesVisited << ", ";
+	json << "\"sphereTests\": " << stats.SphereTests << ", ";
+	json << "\"planeTests\": " << stats.PlaneTests << ", ";
+	json << "\"triangleTests\": " << stats.TriangleTests << ", ";
+	json << "\"primaryMraysPerSecond\": " << stats.CameraRays * megaRaysPerSecond << ", ";
+	json << "\"secondaryMraysPerSecond\": " << secondaryRays * megaRaysPerSecond << ", ";
+	json << "\"totalMraysPerSecond\": " << (stats.CameraRays + secondaryRays) * megaRaysPerSecond << ", ";
+#endif
+
+	json << "\"speedup\": " << baseline.Seconds / run.Seconds;
+	json << (isLast ? " }\n" : " },\n");
+}
+
+bool RunBenchmark(const BatchSettings& settings)
+{
+	const char* sceneNames[] = { "few-spheres", "many-spheres", "glass", "triangle-mesh", "skydome-only" };
+	const int sceneCount = sizeof(sceneNames) / sizeof(sceneNames[0]);
+
+	// Doubles up to every hardware thread, which is always included as well //
+	std::vector<int> threadCounts = settings.ThreadCounts;
+	if(threadCounts.empty())
+	{
+		int threadsAvailable = max((int)std::thread::hardware_concurrency(), 1);
+		for(int threads = 1; threads < threadsAvailable; threads *= 2)
+		{
+			threadCounts.push_back(threads);
+		}
+
+		threadCounts.push_back(threadsAvailable);
+	}
+
+	std::string path = (settings.OutputPath.empty() ? "benchmark" : settings.OutputPath) + ".json";
+	std::ofstream json(path);
+
+	if(!json.is_open())
+	{
+		LOG(Log::MessageType::Error, "Failed to open '" + path + "' for the benchmark results!");
+		return false;
+	}
+
+	LOG("Benchmarking " + std::to_string(sceneCount) + " scenes at " + std::to_string(settings.Width) + "x" +
+		std::to_string(settings.Height) + " with " + std::to_string(settings.SampleCount) + " samples per pixel...");
+
+	// The configuration ends with the peak memory usage of the whole benchmark, so the scenes wait in here until all of them ran //
+	std::ostringstream scenes;
+
+	for(int s = 0; s < sceneCount; s++)
+	{
+		Scene* scene = CreateScene(sceneNames[s], settings.Width, settings.Height);
+		std::vector<BenchmarkRun> runs;
+
+		// Scoped, so the workers are gone before the scene gets deleted //
+		{
+			BatchRenderer renderer(settings, scene);
+
+			for(int threadCount : threadCounts)
+			{
+				BenchmarkRun run;
+				run.ThreadCount = threadCount;
+				run.Seconds = renderer.TimeSamples(threadCount);
+				run.Stats = TraceStats::Gather();
+				runs.push_back(run);
+
+				LOG(std::string(sceneNames[s]) + " - " + std::to_string(threadCount) + " threads: " +
+					std::to_string(run.Seconds * 1000.0f / settings.SampleCount) + " ms per sample");
+			}
+		}
+
+		scenes << "\t\t{\n";
+		scenes << "\t\t\t\"name\": \"" << sceneNames[s] << "\",\n";
+		scenes << "\t\t\t\"primitives\": " << scene->primitives.size() << ",\n";
+		scenes << "\t\t\t\"runs\": [\n";
+
+		// Speedups are relative to the first run, which is single threaded by default //
+		for(unsigned int r = 0; r < runs.size(); r++)
+		{
+			WriteRun(scenes, runs[r], runs[0], settings.SampleCount, r + 1 == runs.size());
+		}
+
+		scenes << "\t\t\t]\n";
+		scenes << (s + 1 == sceneCount ? "\t\t}\n" : "\t\t},\n");
+
+		DeleteScene(scene);
+	}
+
+	json << "{\n";
+	json << "\t\"configuration\": {\n";
+	json << "\t\t\"width\": " << settings.Width << ",\n";
+	json << "\t\t\"height\": " << settings.Height << ",\n";
+	json << "\t\t\"samplesPerPixel\": " << settings.SampleCount << ",\n";
+	json << "\t\t\"threadsAvailable\": " << std::thread::hardware_concurrency() << ",\n";
+	json << "\t\t\"simdVec3\": " << (USE_SIMD_VEC3 ? "true" : "false") << ",\n";
+	json << "\t\t\"traceStats\": " << (USE_TRACE_STATS ? "true" : "false") << ",\n";
+#if defined(__AVX2__)
+	json << "\t\t\"avx2\": true,\n";
+#else
+	json << "\t\t\"avx2\": false,\n";
+#endif
+#if _DEBUG
+	json << "\t\t\"build\": \"Debug\",\n";
+#else
+	json << "\t\t\"build\": \"Release\",\n";
+#endif
+	// Process-wide & it never goes down, so it only says something about the benchmark as a whole //
+	json << "\t\t\"peakMemoryMB\": " << GetPeakMemoryMB() << "\n";
+	json << "\t},\n";
+	json << "\t\"scenes\": [\n";
+	json << scenes.str();
+	json << "\t]\n";
+	json << "}\n";
+
+	LOG("Benchmark results written to '" + path + "'");
+	return true;
+}
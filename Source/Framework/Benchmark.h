@@ -0,0 +1,8 @@
+#pragma once
+
+struct BatchSettings;
+
+// Renders every built-in reference scene once per thread count, with fixed seeds & sample counts,
+// and writes the ray throughput, time per sample, thread scaling & peak memory to '<OutputPath>.json'.
+// Returns false if the results couldn't be written.
+bool RunBenchmark(const BatchSettings& settings);
@@ -0,0 +1,227 @@
+#include "Display.h"
+#include <cstring>
+#include "Utilities/Utilities.h"
+#include "Utilities/Profiler.h"
+
+// The quad its corners are generated from 'gl_VertexID', so it doesn't need any vertex buffers //
+static const char* VertexShaderSource = R"(
+#version 330 core
+out vec2 uv;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	uv = corner;
+	gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+static const char* FragmentShaderSource = R"(
+#version 330 core
+in vec2 uv;
+out vec4 color;
+
+uniform sampler2D screenTexture;
+
+void main()
+{
+	color = vec4(texture(screenTexture, uv).rgb, 1.0);
+}
+)";
+
+static GLuint CompileShader(GLenum type, const char* source)
+{
+	GLuint shader = GL::CreateShader(type);
+	GL::ShaderSource(shader, 1, &source, nullptr);
+	GL::CompileShader(shader);
+
+	GLint compiled = 0;
+	GL::GetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+
+	if(!compiled)
+	{
+		char infoLog[512];
+		GL::GetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+		LOG(Log::MessageType::Error, "Failed to compile the display shader: " + std::string(infoLog));
+	}
+
+	return shader;
+}
+
+Display::Display(unsigned int width, unsigned int height) : width(width), height(height)
+{
+	CreateShaderProgram();
+	GL::GenVertexArrays(1, &vertexArray);
+
+	CreateBuffers();
+}
+
+Display::~Display()
+{
+	DestroyBuffers();
+
+	GL::DeleteVertexArrays(1, &vertexArray);
+	GL::DeleteProgram(shaderProgram);
+}
+
+unsigned int* Display::BeginFrame()
+{
+	PROFILE_ZONE("PBO Wait");
+	// The GPU might still be uploading the last frame that used this region //
+	WaitForRegion(currentRegion);
+
+	return mappedPixels + currentRegion * width * height;
+}
+
+void Display::EndFrame()
+{
+	PROFILE_ZONE("PBO Upload");
+	// With a pixel unpack buffer bound, the 'pixels' argument is an offset into that buffer,
+	// and the copy into the texture happens on the GPU's timeline instead of stalling this thread.
+	std::uintptr_t offset = std::uintptr_t(currentRegion) * width * height * sizeof(unsigned int);
+
+	GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)offset);
+
+	// Left bound, every other upload (like ImGui's font atlas) would read out of this buffer //
+	GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	regionFences[currentRegion] = GL::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	currentRegion = (currentRegion + 1) % RegionCount;
+}
+
+void Display::Draw()
+{
+	GL::UseProgram(shaderProgram);
+	GL::BindVertexArray(vertexArray);
+	GL::ActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	GL::BindVertexArray(0);
+	GL::UseProgram(0);
+}
+
+void Display::Resize(unsigned int width, unsigned int height)
+{
+	DestroyBuffers();
+
+	this->width = width;
+	this->height = height;
+
+	CreateBuffers();
+}
+
+void Display::ReadPixels(unsigned int* destination)
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, destination);
+}
+
+void Display::CreateBuffers()
+{
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	// Coherent, so writes become visible to the GPU without having to flush them explicitly //
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	std::ptrdiff_t bufferSize = std::ptrdiff_t(width) * height * sizeof(unsigned int) * RegionCount;
+
+	GL::GenBuffers(1, &pixelBuffer);
+	GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+	GL::BufferStorage(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, flags);
+	mappedPixels = (unsigned int*)GL::MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize, flags);
+	GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if(!mappedPixels)
+	{
+		LOG(Log::MessageType::Error, "Failed to map the display its pixel buffer!");
+		return;
+	}
+
+	// Starts out black, instead of whatever the texture its memory held //
+	currentRegion = 0;
+	memset(BeginFrame(), 0, sizeof(unsigned int) * width * height);
+	EndFrame();
+}
+
+void Display::DestroyBuffers()
+{
+	for(int i = 0; i < RegionCount; i++)
+	{
+		WaitForRegion(i);
+	}
+
+	GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+	GL::UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	GL::DeleteBuffers(1, &pixelBuffer);
+	glDeleteTextures(1, &texture);
+
+	mappedPixels = nullptr;
+	pixelBuffer = 0;
+	texture = 0;
+}
+
+void Display::CreateShaderProgram()
+{
+	GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, VertexShaderSource);
+	GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, FragmentShaderSource);
+
+	shaderProgram = GL::CreateProgram();
+	GL::AttachShader(shaderProgram, vertexShader);
+	GL::AttachShader(shaderProgram, fragmentShader);
+	GL::LinkProgram(shaderProgram);
+
+	GLint linked = 0;
+	GL::GetProgramiv(shaderProgram, GL_LINK_STATUS, &linked);
+
+	if(!linked)
+	{
+		char infoLog[512];
+		GL::GetProgramInfoLog(shaderProgram, sizeof(infoLog), nullptr, infoLog);
+		LOG(Log::MessageType::Error, "Failed to link the display shader: " + std::string(infoLog));
+	}
+
+	GL::DeleteShader(vertexShader);
+	GL::DeleteShader(fragmentShader);
+
+	GL::UseProgram(shaderProgram);
+	GL::Uniform1i(GL::GetUniformLocation(shaderProgram, "screenTexture"), 0);
+	GL::UseProgram(0);
+}
+
+void Display::WaitForRegion(int region)
+{
+	if(!regionFences[region])
+	{
+		return;
+	}
+
+	// Flushes on the first try, otherwise the fence might never get submitted to the GPU //
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	const std::uint64_t timeout = 1000000; // 1ms, in nanoseconds
+
+	while(true)
+	{
+		GLenum result = GL::ClientWaitSync(regionFences[region], flags, timeout);
+
+		if(result != GL_TIMEOUT_EXPIRED)
+		{
+			break;
+		}
+
+		flags = 0;
+	}
+
+	GL::DeleteSync(regionFences[region]);
+	regionFences[region] = nullptr;
+}
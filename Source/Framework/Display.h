@@ -0,0 +1,45 @@
+#pragma once
+#include "OpenGL.h"
+
+/// <summary>
+/// Puts the post-processed frame on screen as a textured fullscreen quad.
+/// Frames get written straight into a persistently mapped pixel buffer, which is split up in regions,
+/// so the GPU can still be uploading the previous frame out of one while the next gets written into another.
+/// Nothing gets uploaded unless a new frame was written, drawing only samples the texture.
+/// </summary>
+class Display
+{
+public:
+	Display(unsigned int width, unsigned int height);
+	~Display();
+
+	// Returns the region the next frame gets written into, as 8-bit RGBA, bottom row first //
+	unsigned int* BeginFrame();
+	void EndFrame();
+
+	void Draw();
+	void Resize(unsigned int width, unsigned int height);
+	void ReadPixels(unsigned int* destination);
+
+private:
+	void CreateBuffers();
+	void DestroyBuffers();
+	void CreateShaderProgram();
+	void WaitForRegion(int region);
+
+private:
+	static const int RegionCount = 2;
+
+	unsigned int width;
+	unsigned int height;
+
+	GLuint texture = 0;
+	GLuint pixelBuffer = 0;
+	unsigned int* mappedPixels = nullptr;
+
+	int currentRegion = 0;
+	GL::Sync regionFences[RegionCount] = {};
+
+	GLuint shaderProgram = 0;
+	GLuint vertexArray = 0;
+};
@@ -1,17 +1,22 @@
 #include "Editor.h"
 #include <filesystem>
+#include <cstdarg>
+#include <ctime>
 
 #include "Framework/App.h"
 #include "Framework/Input.h"
 #include "Framework/Renderer.h"
 #include "Framework/SceneManager.h"
+#include "Framework/WorkerSystem.h"
 
 #include "Graphics/RayTracer.h"
+#include "Graphics/TraceStats.h"
 #include "Graphics/Sphere.h"
 #include "Graphics/PlaneInfinite.h"
 #include "Graphics/PostProcessor.h"
 
 #include "Utilities/LogHelper.h"
+#include "Utilities/Profiler.h"
 
 Editor::Editor(GLFWwindow* window, App* app) : app(app)
 {
@@ -84,6 +89,7 @@ void Editor::Render()
 		return;
 	}
 
+	PROFILE_ZONE("ImGui Render");
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
@@ -110,7 +116,25 @@ void Editor::MenuBar()
 			app->renderer->MakeScreenshot();
 		}
 
-		int offset = renderer->screenWidth - 800;
+#if USE_PROFILER
+		// The last few thousand zones of every thread, open in chrome://tracing or ui.perfetto.dev //
+		if(ImGui::Button("Save Profile"))
+		{
+			std::filesystem::create_directories(profilePath);
+			std::string path = profilePath + std::to_string(time(NULL)) + ".json";
+
+			if(Profiler::WriteChromeTrace(path))
+			{
+				LOG("Profile written to '" + path + "'");
+			}
+			else
+			{
+				LOG(Log::MessageType::Error, "Failed to write '" + path + "'");
+			}
+		}
+#endif
+
+		int offset = renderer->screenWidth - (USE_PROFILER ? 890 : 800);
 		if(offset > 10)
 		{
 			ImGui::Dummy(ImVec2(offset, 0));
@@ -158,6 +182,18 @@ void Editor::MenuBar()
 	
 		ImGui::Separator();
 	
+		// Adaptive Sampling //
+		if(app->renderer->workerSystem->useAdaptiveSampling.load())
+		{
+			ImGui::PushFont(boldFont);
+			ImGui::Text("Converged:");
+			ImGui::PopFont();
+
+			ImGui::Text("%.1f%%", app->renderer->workerSystem->GetConvergedPercentage());
+
+			ImGui::Separator();
+		}
+	
 		// Time Elasped // 
 		ImGui::PushFont(boldFont);
 		ImGui::Text("Time Elapsed:");
@@ -237,11 +273,39 @@ void Editor::SceneSettings()
 		CameraSettings();
 	}
 
+	if(ImGui::CollapsingHeader("Light Settings"))
+	{
+		LightSettings();
+	}
+
+#if USE_TRACE_STATS
+	if(ImGui::CollapsingHeader("Trace Statistics"))
+	{
+		TraceStatistics();
+	}
+#endif
+
 	ImGui::PopFont();
 	ImGui::End();
 	ImGui::PopFont();
 }
 
+// A label & a printf formatted value, as a row of the two settings columns //
+static void StatisticRow(const char* label, const char* format, ...)
+{
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text(label);
+	ImGui::NextColumn();
+
+	va_list args;
+	va_start(args, format);
+	ImGui::TextV(format, args);
+	va_end(args);
+
+	ImGui::NextColumn();
+}
+
 void Editor::PathTracerSettings()
 {
 	Renderer* renderer = app->renderer;
@@ -278,6 +342,126 @@ void Editor::PathTracerSettings()
 	ImGui::Text("Use Skydome");
 	ImGui::NextColumn();
 	if(ImGui::Checkbox("##4", &renderer->rayTracer->useSkydomeTexture)) { sceneUpdated = true; }
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Random Seed");
+	ImGui::NextColumn();
+	if(ImGui::InputScalar("##3", ImGuiDataType_U32, &renderer->rayTracer->randomSeed)) { sceneUpdated = true; }
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Sampler");
+	ImGui::NextColumn();
+	const char* samplerNames[] = { "Independent", "Stratified", "Sobol (Owen Scrambled)" };
+	int samplerIndex = int(renderer->rayTracer->GetSamplerType());
+	if(ImGui::Combo("##20", &samplerIndex, samplerNames, IM_ARRAYSIZE(samplerNames)))
+	{
+		renderer->rayTracer->SetSampler(SamplerType(samplerIndex));
+		sceneUpdated = true;
+	}
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Heatmap");
+	ImGui::NextColumn();
+	// Only the trace time can be measured without the trace statistics //
+	const char* heatmapNames[] = { "Off", "Trace Time", "Intersection Tests", "Path Length" };
+	const char* heatmapUnits[] = { "", "us", "tests", "rays" };
+	int heatmapIndex = int(renderer->rayTracer->heatmapMode);
+	if(ImGui::Combo("##24", &heatmapIndex, heatmapNames, USE_TRACE_STATS ? IM_ARRAYSIZE(heatmapNames) : 2))
+	{
+		renderer->rayTracer->heatmapMode = HeatmapMode(heatmapIndex);
+		renderer->postProcessor->showHeatmap = heatmapIndex != 0;
+		sceneUpdated = true;
+	}
+	ImGui::NextColumn();
+
+	if(renderer->postProcessor->showHeatmap)
+	{
+		StatisticRow("Heatmap Max (99%)", "%.2f %s", renderer->postProcessor->heatmapMax, heatmapUnits[heatmapIndex]);
+	}
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Thread Count");
+	ImGui::NextColumn();
+	int threadCount = renderer->workerSystem->threadCount;
+	if(ImGui::InputInt("##16", &threadCount))
+	{
+		renderer->workerSystem->SetThreadCount(threadCount);
+		sceneUpdated = true;
+	}
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Tile Size");
+	ImGui::NextColumn();
+	int tileSize = renderer->workerSystem->tileSize;
+	if(ImGui::InputInt("##17", &tileSize))
+	{
+		renderer->workerSystem->SetTileSize(max(tileSize, 1));
+		sceneUpdated = true;
+	}
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Asynchronous Accumulation");
+	ImGui::NextColumn();
+	bool asynchronous = renderer->workerSystem->IsAsynchronous();
+	if(ImGui::Checkbox("##18", &asynchronous))
+	{
+		renderer->workerSystem->SetAsynchronous(asynchronous);
+		sceneUpdated = true;
+	}
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Adaptive Sampling");
+	ImGui::NextColumn();
+	bool useAdaptiveSampling = renderer->workerSystem->useAdaptiveSampling.load();
+	if(ImGui::Checkbox("##21", &useAdaptiveSampling))
+	{
+		renderer->workerSystem->useAdaptiveSampling = useAdaptiveSampling;
+		sceneUpdated = true;
+	}
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Adaptive Threshold");
+	ImGui::NextColumn();
+	float adaptiveThreshold = renderer->workerSystem->adaptiveThreshold.load();
+	if(ImGui::DragFloat("##22", &adaptiveThreshold, 0.0005f, 0.0001f, 1.0f, "%.4f"))
+	{
+		renderer->workerSystem->adaptiveThreshold = adaptiveThreshold;
+		sceneUpdated = true;
+	}
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Adaptive Min Samples");
+	ImGui::NextColumn();
+	int adaptiveMinSamples = renderer->workerSystem->adaptiveMinSamples;
+	if(ImGui::InputInt("##23", &adaptiveMinSamples))
+	{
+		renderer->workerSystem->adaptiveMinSamples = max(adaptiveMinSamples, 2);
+		sceneUpdated = true;
+	}
+	ImGui::NextColumn();
+
+	ImGui::Separator();
+	ImGui::AlignTextToFramePadding();
+	ImGui::Text("Next Event Estimation");
+	ImGui::NextColumn();
+	if(ImGui::Checkbox("##19", &renderer->rayTracer->useNextEventEstimation)) { sceneUpdated = true; }
 
 	ImGui::Columns(1);
 	ImGui::Separator();
@@ -431,17 +615,147 @@ void Editor::CameraSettings()
 	}
 }
 
+void Editor::LightSettings()
+{
+	std::vector<Light>& lights = activeScene->Lights;
+	int lightToRemove = -1;
+
+	for(int i = 0; i < lights.size(); i++)
+	{
+		Light& light = lights[i];
+		ImGui::PushID(i);
+
+		ImGui::Separator();
+		ImGui::Text(light.HasArea ? "Area Light" : "Point Light");
+		ImGui::Columns(2);
+
+		ImGui::Separator();
+		ImGui::AlignTextToFramePadding();
+		ImGui::Text("Position");
+		ImGui::NextColumn();
+		if(ImGui::DragFloat3("##0", &light.Position.x, 0.05f, 0.0f, 0.0f, "%.2f")) { sceneUpdated = true; }
+		ImGui::NextColumn();
+
+		ImGui::Separator();
+		ImGui::AlignTextToFramePadding();
+		ImGui::Text("Color");
+		ImGui::NextColumn();
+		if(ImGui::ColorEdit3("##1", &light.Color.x)) { sceneUpdated = true; }
+		ImGui::NextColumn();
+
+		ImGui::Separator();
+		ImGui::AlignTextToFramePadding();
+		ImGui::Text("Intensity");
+		ImGui::NextColumn();
+		if(ImGui::DragFloat("##2", &light.Intensity, 0.05f, 0.0f, 1000.0f)) { sceneUpdated = true; }
+		ImGui::NextColumn();
+
+		ImGui::Separator();
+		ImGui::AlignTextToFramePadding();
+		ImGui::Text("Has Area");
+		ImGui::NextColumn();
+		if(ImGui::Checkbox("##3", &light.HasArea)) { sceneUpdated = true; }
+		ImGui::NextColumn();
+
+		if(light.HasArea)
+		{
+			ImGui::Separator();
+			ImGui::AlignTextToFramePadding();
+			ImGui::Text("Size (X, Z)");
+			ImGui::NextColumn();
+			float size[2] = { light.Scale.x, light.Scale.z };
+			if(ImGui::DragFloat2("##4", size, 0.01f, 0.0f, 100.0f, "%.2f"))
+			{
+				light.Scale.x = size[0];
+				light.Scale.z = size[1];
+				sceneUpdated = true;
+			}
+			ImGui::NextColumn();
+		}
+
+		ImGui::Columns(1);
+
+		if(ImGui::Button("Remove Light"))
+		{
+			lightToRemove = i;
+		}
+
+		ImGui::PopID();
+	}
+
+	if(lightToRemove != -1)
+	{
+		lights.erase(lights.begin() + lightToRemove);
+		sceneUpdated = true;
+	}
+
+	ImGui::Separator();
+	if(ImGui::Button("Add Light"))
+	{
+		lights.push_back(Light());
+		sceneUpdated = true;
+	}
+}
+
+void Editor::TraceStatistics()
+{
+	// Everything traced since sampling got restarted //
+	TraceStats stats = TraceStats::Gather();
+	float paths = float(max(stats.CameraRays, 1ull));
+	float rays = float(max(stats.CameraRays + stats.BounceRays, 1ull));
+	float shadowRays = float(max(stats.ShadowRays, 1ull));
+	float allRays = rays + stats.ShadowRays;
+
+	ImGui::Columns(2);
+
+	StatisticRow("Camera Rays", "%llu", stats.CameraRays);
+	StatisticRow("Bounce Rays", "%llu", stats.BounceRays);
+	StatisticRow("Shadow Rays", "%llu", stats.ShadowRays);
+	StatisticRow("Occluded", "%.1f%%", stats.OccludedShadowRays / shadowRays * 100.0f);
+
+	// How paths ended //
+	StatisticRow("Sky Misses", "%.1f%%", stats.SkyMisses / paths * 100.0f);
+	StatisticRow("Russian Roulette", "%.1f%%", stats.RussianRouletteTerminations / paths * 100.0f);
+	StatisticRow("Max Ray Depth", "%.1f%%", stats.MaxDepthTerminations / paths * 100.0f);
+
+	// Primitive tests include the ones of shadow rays //
+	StatisticRow("Nodes Per Ray", "%.2f", stats.NodesVisited / rays);
+	StatisticRow("Nodes Per Shadow Ray", "%.2f", stats.ShadowNodesVisited / shadowRays);
+	StatisticRow("Sphere Tests Per Ray", "%.2f", stats.SphereTests / allRays);
+	StatisticRow("Plane Tests Per Ray", "%.2f", stats.PlaneTests / allRays);
+	StatisticRow("Triangle Tests Per Ray", "%.2f", stats.TriangleTests / allRays);
+
+	ImGui::Columns(1);
+	ImGui::Separator();
+}
+
 void Editor::PostProcessSettings()
 {
 	PostProcessor* pp = app->renderer->postProcessor;
 
 	ImGui::Begin("Post Processor");
-	if(ImGui::DragFloat("Gamma", &pp->gamma, 0.01f, 0.0f, 10.0f)) { pp->gammaInverse = 1.0f / pp->gamma; }
-	if(ImGui::DragFloat("Exposure", &pp->exposure, 0.01f, 0.0f, 10.0f));
-	ImGui::Checkbox("Use ACES Tonemapping", &pp->doACESTonemapping);
+	bool settingsChanged = false;
+
+	if(ImGui::DragFloat("Gamma", &pp->gamma, 0.01f, 0.0f, 10.0f)) { pp->SetGamma(pp->gamma); settingsChanged = true; }
+	settingsChanged |= ImGui::DragFloat("Exposure", &pp->exposure, 0.01f, 0.0f, 10.0f);
+	settingsChanged |= ImGui::Checkbox("Use ACES Tonemapping", &pp->doACESTonemapping);
 	ImGui::Separator();
-	ImGui::Checkbox("Use Gaussian Filtering", &pp->doGaussianFilter);
-	if(ImGui::DragFloat("Gaussian Gamma", &pp->gaussianSigma, 0.01f, 0.01f, 10.0f)) { pp->GenerateGaussianFilter(); }
+	settingsChanged |= ImGui::Checkbox("Use Denoiser", &pp->doDenoising);
+	settingsChanged |= ImGui::SliderInt("Denoiser Iterations", &pp->denoiseIterations, 1, 8);
+	settingsChanged |= ImGui::DragFloat("Color Phi", &pp->denoiseColorPhi, 0.01f, 0.001f, 100.0f);
+	settingsChanged |= ImGui::DragFloat("Normal Phi", &pp->denoiseNormalPhi, 0.001f, 0.001f, 10.0f);
+	settingsChanged |= ImGui::DragFloat("Depth Phi", &pp->denoiseDepthPhi, 0.001f, 0.001f, 10.0f);
+	ImGui::Separator();
+	settingsChanged |= ImGui::Checkbox("Use Gaussian Filtering", &pp->doGaussianFilter);
+	if(ImGui::SliderInt("Gaussian Radius", &pp->gaussianRadius, 1, PostProcessor::MaxGaussianRadius)) { pp->GenerateGaussianFilter(); settingsChanged = true; }
+	if(ImGui::DragFloat("Gaussian Sigma", &pp->gaussianSigma, 0.01f, 0.01f, 10.0f)) { pp->GenerateGaussianFilter(); settingsChanged = true; }
+
+	// Once sampling is done, the screen only gets post-processed again when asked to //
+	if(settingsChanged)
+	{
+		app->renderer->screenOutdated = true;
+	}
+
 	ImGui::End();
 }
 
@@ -40,6 +40,8 @@ private:
 	void PathTracerSettings();
 	void SkydomeSettings();
 	void CameraSettings();
+	void LightSettings();
+	void TraceStatistics();
 	void PostProcessSettings();
 
 	void PrimitiveSelection();
@@ -76,6 +78,7 @@ private:
 
 	std::vector<std::string> exrFilePaths;
 	std::string placeholderName;
+	std::string profilePath = "Profiles/";
 
 	Primitive* selectedPrimitive = nullptr;
 
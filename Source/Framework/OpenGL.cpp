@@ -0,0 +1,91 @@
+#include "OpenGL.h"
+#include "Utilities/Utilities.h"
+
+namespace GL
+{
+	GenBuffersFunction GenBuffers = nullptr;
+	DeleteBuffersFunction DeleteBuffers = nullptr;
+	BindBufferFunction BindBuffer = nullptr;
+	BufferStorageFunction BufferStorage = nullptr;
+	MapBufferRangeFunction MapBufferRange = nullptr;
+	UnmapBufferFunction UnmapBuffer = nullptr;
+
+	FenceSyncFunction FenceSync = nullptr;
+	ClientWaitSyncFunction ClientWaitSync = nullptr;
+	DeleteSyncFunction DeleteSync = nullptr;
+
+	CreateShaderFunction CreateShader = nullptr;
+	ShaderSourceFunction ShaderSource = nullptr;
+	CompileShaderFunction CompileShader = nullptr;
+	GetShaderivFunction GetShaderiv = nullptr;
+	GetShaderInfoLogFunction GetShaderInfoLog = nullptr;
+	DeleteShaderFunction DeleteShader = nullptr;
+	CreateProgramFunction CreateProgram = nullptr;
+	AttachShaderFunction AttachShader = nullptr;
+	LinkProgramFunction LinkProgram = nullptr;
+	GetProgramivFunction GetProgramiv = nullptr;
+	GetProgramInfoLogFunction GetProgramInfoLog = nullptr;
+	DeleteProgramFunction DeleteProgram = nullptr;
+	UseProgramFunction UseProgram = nullptr;
+	GetUniformLocationFunction GetUniformLocation = nullptr;
+	Uniform1iFunction Uniform1i = nullptr;
+
+	GenVertexArraysFunction GenVertexArrays = nullptr;
+	DeleteVertexArraysFunction DeleteVertexArrays = nullptr;
+	BindVertexArrayFunction BindVertexArray = nullptr;
+	ActiveTextureFunction ActiveTexture = nullptr;
+
+	template<typename Function>
+	static bool Load(Function& function, const char* name)
+	{
+		function = (Function)glfwGetProcAddress(name);
+
+		if(!function)
+		{
+			LOG(Log::MessageType::Error, "Failed to load OpenGL function: " + std::string(name));
+			return false;
+		}
+
+		return true;
+	}
+
+	bool LoadFunctions()
+	{
+		// Everything gets attempted, so the log lists every missing function at once //
+		bool loaded = true;
+
+		loaded &= Load(GenBuffers, "glGenBuffers");
+		loaded &= Load(DeleteBuffers, "glDeleteBuffers");
+		loaded &= Load(BindBuffer, "glBindBuffer");
+		loaded &= Load(BufferStorage, "glBufferStorage");
+		loaded &= Load(MapBufferRange, "glMapBufferRange");
+		loaded &= Load(UnmapBuffer, "glUnmapBuffer");
+
+		loaded &= Load(FenceSync, "glFenceSync");
+		loaded &= Load(ClientWaitSync, "glClientWaitSync");
+		loaded &= Load(DeleteSync, "glDeleteSync");
+
+		loaded &= Load(CreateShader, "glCreateShader");
+		loaded &= Load(ShaderSource, "glShaderSource");
+		loaded &= Load(CompileShader, "glCompileShader");
+		loaded &= Load(GetShaderiv, "glGetShaderiv");
+		loaded &= Load(GetShaderInfoLog, "glGetShaderInfoLog");
+		loaded &= Load(DeleteShader, "glDeleteShader");
+		loaded &= Load(CreateProgram, "glCreateProgram");
+		loaded &= Load(AttachShader, "glAttachShader");
+		loaded &= Load(LinkProgram, "glLinkProgram");
+		loaded &= Load(GetProgramiv, "glGetProgramiv");
+		loaded &= Load(GetProgramInfoLog, "glGetProgramInfoLog");
+		loaded &= Load(DeleteProgram, "glDeleteProgram");
+		loaded &= Load(UseProgram, "glUseProgram");
+		loaded &= Load(GetUniformLocation, "glGetUniformLocation");
+		loaded &= Load(Uniform1i, "glUniform1i");
+
+		loaded &= Load(GenVertexArrays, "glGenVertexArrays");
+		loaded &= Load(DeleteVertexArrays, "glDeleteVertexArrays");
+		loaded &= Load(BindVertexArray, "glBindVertexArray");
+		loaded &= Load(ActiveTexture, "glActiveTexture");
+
+		return loaded;
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <GLFW/glfw3.h>
+
+// 'opengl32.lib' only exports OpenGL 1.1, everything newer that the renderer
+// needs gets loaded at runtime through GLFW, once a context is current.
+
+#if defined(_WIN32)
+#define GLFUNCTION __stdcall
+#else
+#define GLFUNCTION
+#endif
+
+// Constants //
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0 0x84C0
+#endif
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+
+namespace GL
+{
+	typedef struct __GLsync* Sync;
+
+	// Buffers //
+	typedef void (GLFUNCTION* GenBuffersFunction)(GLsizei count, GLuint* buffers);
+	typedef void (GLFUNCTION* DeleteBuffersFunction)(GLsizei count, const GLuint* buffers);
+	typedef void (GLFUNCTION* BindBufferFunction)(GLenum target, GLuint buffer);
+	typedef void (GLFUNCTION* BufferStorageFunction)(GLenum target, std::ptrdiff_t size, const void* data, GLbitfield flags);
+	typedef void* (GLFUNCTION* MapBufferRangeFunction)(GLenum target, std::intptr_t offset, std::ptrdiff_t length, GLbitfield access);
+	typedef GLboolean (GLFUNCTION* UnmapBufferFunction)(GLenum target);
+
+	// Synchronization //
+	typedef Sync (GLFUNCTION* FenceSyncFunction)(GLenum condition, GLbitfield flags);
+	typedef GLenum (GLFUNCTION* ClientWaitSyncFunction)(Sync sync, GLbitfield flags, std::uint64_t timeout);
+	typedef void (GLFUNCTION* DeleteSyncFunction)(Sync sync);
+
+	// Shaders //
+	typedef GLuint (GLFUNCTION* CreateShaderFunction)(GLenum type);
+	typedef void (GLFUNCTION* ShaderSourceFunction)(GLuint shader, GLsizei count, const char* const* source, const GLint* length);
+	typedef void (GLFUNCTION* CompileShaderFunction)(GLuint shader);
+	typedef void (GLFUNCTION* GetShaderivFunction)(GLuint shader, GLenum name, GLint* parameters);
+	typedef void (GLFUNCTION* GetShaderInfoLogFunction)(GLuint shader, GLsizei bufferSize, GLsizei* length, char* infoLog);
+	typedef void (GLFUNCTION* DeleteShaderFunction)(GLuint shader);
+	typedef GLuint (GLFUNCTION* CreateProgramFunction)();
+	typedef void (GLFUNCTION* AttachShaderFunction)(GLuint program, GLuint shader);
+	typedef void (GLFUNCTION* LinkProgramFunction)(GLuint program);
+	typedef void (GLFUNCTION* GetProgramivFunction)(GLuint program, GLenum name, GLint* parameters);
+	typedef void (GLFUNCTION* GetProgramInfoLogFunction)(GLuint program, GLsizei bufferSize, GLsizei* length, char* infoLog);
+	typedef void (GLFUNCTION* DeleteProgramFunction)(GLuint program);
+	typedef void (GLFUNCTION* UseProgramFunction)(GLuint program);
+	typedef GLint (GLFUNCTION* GetUniformLocationFunction)(GLuint program, const char* name);
+	typedef void (GLFUNCTION* Uniform1iFunction)(GLint location, GLint value);
+
+	// Vertex Arrays & Textures //
+	typedef void (GLFUNCTION* GenVertexArraysFunction)(GLsizei count, GLuint* arrays);
+	typedef void (GLFUNCTION* DeleteVertexArraysFunction)(GLsizei count, const GLuint* arrays);
+	typedef void (GLFUNCTION* BindVertexArrayFunction)(GLuint array);
+	typedef void (GLFUNCTION* ActiveTextureFunction)(GLenum texture);
+
+	extern GenBuffersFunction GenBuffers;
+	extern DeleteBuffersFunction DeleteBuffers;
+	extern BindBufferFunction BindBuffer;
+	extern BufferStorageFunction BufferStorage;
+	extern MapBufferRangeFunction MapBufferRange;
+	extern UnmapBufferFunction UnmapBuffer;
+
+	extern FenceSyncFunction FenceSync;
+	extern ClientWaitSyncFunction ClientWaitSync;
+	extern DeleteSyncFunction DeleteSync;
+
+	extern CreateShaderFunction CreateShader;
+	extern ShaderSourceFunction ShaderSource;
+	extern CompileShaderFunction CompileShader;
+	extern GetShaderivFunction GetShaderiv;
+	extern GetShaderInfoLogFunction GetShaderInfoLog;
+	extern DeleteShaderFunction DeleteShader;
+	extern CreateProgramFunction CreateProgram;
+	extern AttachShaderFunction AttachShader;
+	extern LinkProgramFunction LinkProgram;
+	extern GetProgramivFunction GetProgramiv;
+	extern GetProgramInfoLogFunction GetProgramInfoLog;
+	extern DeleteProgramFunction DeleteProgram;
+	extern UseProgramFunction UseProgram;
+	extern GetUniformLocationFunction GetUniformLocation;
+	extern Uniform1iFunction Uniform1i;
+
+	extern GenVertexArraysFunction GenVertexArrays;
+	extern DeleteVertexArraysFunction DeleteVertexArrays;
+	extern BindVertexArrayFunction BindVertexArray;
+	extern ActiveTextureFunction ActiveTexture;
+
+	// Has to be called with a current context, returns false if any function is missing (OpenGL 4.4 or newer is required) //
+	bool LoadFunctions();
+}
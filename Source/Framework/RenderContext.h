@@ -0,0 +1,30 @@
+#pragma once
+#include "Math/Vec3.h"
+
+class RayTracer;
+struct SurfaceFeatures;
+
+/// <summary>
+/// Everything the WorkerSystem traces with and accumulates into.
+/// Both the windowed 'Renderer' and the headless 'BatchRenderer' own one,
+/// so the workers never depend on GLFW, ImGui or a window.
+/// </summary>
+class RenderContext
+{
+protected:
+	RayTracer* rayTracer = nullptr;
+
+	// Ray Tracing //
+	int sampleCount = 1;
+	int targetSampleCount = 100000;
+
+	// Sample Buffers //
+	vec3* sampleBuffer = nullptr;
+	vec3* halfSampleBuffer = nullptr; // Only every other sample, used to estimate the error for adaptive sampling
+	SurfaceFeatures* featureBuffer = nullptr; // First-hit albedo, normal & depth, summed like 'sampleBuffer'
+
+	// Set by the workers once every tile of an iteration has been traced //
+	bool updateScreenBuffer = false;
+
+	friend class WorkerSystem;
+};
@@ -7,8 +7,12 @@
 
 #include "Graphics/RayTracer.h"
 #include "Graphics/PostProcessor.h"
+#include "Graphics/SurfaceFeatures.h"
+#include "Graphics/TraceStats.h"
 
 #include "Framework/Input.h"
+#include "Framework/OpenGL.h"
+#include "Framework/Display.h"
 #include "Framework/SceneManager.h"
 #include "Framework/WorkerSystem.h"
 #include "Utilities/Utilities.h"
@@ -17,9 +21,11 @@ Renderer::Renderer(const std::string& windowName, unsigned int screenWidth, unsi
 {
 	// Create Back Buffers // 
 	bufferSize = screenWidth * screenHeight;
-	screenBuffer = new unsigned int[bufferSize];
 	sampleBuffer = new vec3[bufferSize];
-	ClearBuffer(screenBuffer, 0x00, bufferSize);
+	halfSampleBuffer = new vec3[bufferSize];
+	snapshotBuffer = new vec3[bufferSize];
+	featureBuffer = new SurfaceFeatures[bufferSize];
+	featureSnapshotBuffer = new SurfaceFeatures[bufferSize];
 
 	// Initialize GLFW & Window // 
 	if(!glfwInit())
@@ -41,11 +47,18 @@ Renderer::Renderer(const std::string& windowName, unsigned int screenWidth, unsi
 	LOG("Succesfully created a window.");
 	glfwMakeContextCurrent(window);
 
+	if(!GL::LoadFunctions())
+	{
+		LOG(Log::MessageType::Error, "Failed to load OpenGL 4.4 functions!");
+		assert(false);
+	}
+
 	// Intialize sub-systems //
 	sceneManager = new SceneManager(screenWidth, screenHeight);
 	rayTracer = new RayTracer(screenWidth, screenHeight, sceneManager->GetActiveScene());
 	workerSystem = new WorkerSystem(this, screenWidth, screenHeight);
-	postProcessor = new PostProcessor(screenWidth, screenHeight);
+	postProcessor = new PostProcessor(workerSystem, screenWidth, screenHeight);
+	display = new Display(screenWidth, screenHeight);
 
 	clock = new std::chrono::high_resolution_clock();
 	t0 = std::chrono::time_point_cast<std::chrono::milliseconds>((clock->now())).time_since_epoch();
@@ -54,7 +67,9 @@ Renderer::Renderer(const std::string& windowName, unsigned int screenWidth, unsi
 
 Renderer::~Renderer()
 {
+	delete workerSystem;
 	delete sceneManager;
+	delete display;
 
 	glfwDestroyWindow(window);
 }
@@ -118,15 +133,27 @@ void Renderer::Update()
 
 void Renderer::Render()
 {
-	if(updateScreenBuffer)
+	if(workerSystem->IsAsynchronous())
+	{
+		RenderAsynchronous();
+	}
+	else if(updateScreenBuffer)
 	{
 		auto t1 = std::chrono::time_point_cast<std::chrono::milliseconds>((clock->now())).time_since_epoch();
 		deltaTime = (t1 - t0).count() * .001;
 		t0 = t1;
 
-		postProcessor->PostProcess(sampleBuffer, sampleCount);
-		postProcessor->CopyProcessedData(screenBuffer);
-		sampleCount++;
+		// Tiles can have a different amount of samples once some of them converged //
+		if(screenOutdated)
+		{
+			workerSystem->TakeSnapshot(snapshotBuffer, featureSnapshotBuffer);
+			PresentSnapshot();
+		}
+
+		if(!workerSystem->IsConverged())
+		{
+			sampleCount++;
+		}
 
 		if(resizeScreenBuffers)
 		{
@@ -142,9 +169,10 @@ void Renderer::Render()
 			ClearSampleBuffer();
 		}
 
-		if(sampleCount < targetSampleCount)
+		if(sampleCount < targetSampleCount && !workerSystem->IsConverged())
 		{
 			workerSystem->NotifyWorkers();
+			screenOutdated = true;
 
 			renderTime += deltaTime;
 			FPSLog[sampleCount % FPSLogSize] = deltaTime;
@@ -153,8 +181,71 @@ void Renderer::Render()
 		updateScreenBuffer = false;
 	}
 
-	// Copy screen-buffer data over to the Window's buffer.
-	glDrawPixels(screenWidth, screenHeight, GL_RGBA, GL_UNSIGNED_BYTE, screenBuffer);
+	// Only samples the texture, it only gets uploaded to when a new frame got presented //
+	display->Draw();
+}
+
+/// <summary>
+/// Workers keep accumulating samples per tile without a barrier between samples,
+/// the screen shows a snapshot of wherever they currently are.
+/// </summary>
+void Renderer::RenderAsynchronous()
+{
+	auto t1 = std::chrono::time_point_cast<std::chrono::milliseconds>((clock->now())).time_since_epoch();
+	deltaTime = (t1 - t0).count() * .001;
+	t0 = t1;
+
+	// Buffers can only be touched once no worker is inside of a tile anymore //
+	if(resizeScreenBuffers || clearScreenBuffers)
+	{
+		workerSystem->Pause();
+
+		if(resizeScreenBuffers)
+		{
+			int width, height;
+			glfwGetWindowSize(window, &width, &height);
+			ResizeScreenBuffers(width, height);
+
+			resizeScreenBuffers = false;
+		}
+
+		if(clearScreenBuffers)
+		{
+			ClearSampleBuffer();
+		}
+
+		workerSystem->NotifyWorkers();
+	}
+
+	// Once every tile is done, the screen stays the same until something changes //
+	bool samplingFinished = snapshotConverged || sampleCount >= targetSampleCount;
+
+	if(screenOutdated || !samplingFinished)
+	{
+		// Checked before the snapshot, so a tile can't converge after it got copied //
+		snapshotConverged = workerSystem->IsConverged();
+		sampleCount = workerSystem->TakeSnapshot(snapshotBuffer, featureSnapshotBuffer);
+		PresentSnapshot();
+	}
+
+	if(sampleCount < targetSampleCount && !workerSystem->IsConverged())
+	{
+		renderTime += deltaTime;
+	}
+
+	frameCount++;
+	FPSLog[frameCount % FPSLogSize] = deltaTime;
+}
+
+/// <summary>
+/// Post-processes the snapshot straight into the display its mapped memory, and uploads it.
+/// </summary>
+void Renderer::PresentSnapshot()
+{
+	postProcessor->PostProcess(snapshotBuffer, featureSnapshotBuffer, 1, display->BeginFrame());
+	display->EndFrame();
+
+	screenOutdated = false;
 }
 
 void Renderer::RestartSampling()
@@ -174,14 +265,21 @@ void Renderer::ResizeScreenBuffers(int width, int height)
 
 	glViewport(0, 0, screenWidth, screenHeight);
 	bufferSize = screenWidth * screenHeight;
-	delete screenBuffer;
-	delete sampleBuffer;
+	delete[] sampleBuffer;
+	delete[] halfSampleBuffer;
+	delete[] snapshotBuffer;
+	delete[] featureBuffer;
+	delete[] featureSnapshotBuffer;
 
-	screenBuffer = new unsigned int[bufferSize];
 	sampleBuffer = new vec3[bufferSize];
+	halfSampleBuffer = new vec3[bufferSize];
+	snapshotBuffer = new vec3[bufferSize];
+	featureBuffer = new SurfaceFeatures[bufferSize];
+	featureSnapshotBuffer = new SurfaceFeatures[bufferSize];
 
 	clearScreenBuffers = true;
 	postProcessor->Resize(screenWidth, screenHeight);
+	display->Resize(screenWidth, screenHeight);
 	workerSystem->ResizeJobTiles(screenWidth, screenHeight);
 	sceneManager->GetActiveScene()->Camera->SetupVirtualPlane(screenWidth, screenHeight);
 }
@@ -196,23 +294,23 @@ void Renderer::ClearSampleBuffer()
 	sceneManager->UpdateScene();
 
 	memset(sampleBuffer, 0.0f, sizeof(vec3) * bufferSize);
+	memset(halfSampleBuffer, 0.0f, sizeof(vec3) * bufferSize);
+	memset(featureBuffer, 0, sizeof(SurfaceFeatures) * bufferSize);
+	workerSystem->ClearTileSamples();
+	TraceStats::Reset();
 	clearScreenBuffers = false;
+	screenOutdated = true;
 }
 
 void Renderer::MakeScreenshot()
 {
 	unsigned int stride = screenWidth * sizeof(unsigned int);
 	unsigned int* screenshotBuffer = new unsigned int[screenWidth * screenHeight];
+	display->ReadPixels(screenshotBuffer);
 
-	for(int x = 0; x < screenWidth; x++)
+	for(unsigned int i = 0; i < screenWidth * screenHeight; i++)
 	{
-		for(int y = 0; y < screenHeight; y++)
-		{
-			int index = x + y * screenWidth;
-			unsigned int c = screenBuffer[index];
-			c += (255 << 24);
-			screenshotBuffer[index] = c;
-		}
+		screenshotBuffer[i] |= (255 << 24);
 	}
 
 	std::string timeStamp = std::to_string(time(NULL));
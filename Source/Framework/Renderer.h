@@ -1,17 +1,18 @@
 #pragma once
-#include "Math/Vec3.h"
+#include "Framework/RenderContext.h"
 #include <string>
 #include <chrono>
 
 struct GLFWwindow;
 
 class Primitive;
-class RayTracer;
 class SceneManager;
 class WorkerSystem;
 class PostProcessor;
+class Display;
+struct SurfaceFeatures;
 
-class Renderer
+class Renderer : public RenderContext
 {
 public:
 	Renderer(const std::string& windowName, unsigned int screenWidth, unsigned int screenHeight);
@@ -25,24 +26,25 @@ public:
 	GLFWwindow* GetWindow();
 
 private:
+	void RenderAsynchronous();
+	void PresentSnapshot();
+
 	void ResizeScreenBuffers(int width, int height);
 	void ClearSampleBuffer();
 
 	void MakeScreenshot();
 
 private:
-	RayTracer* rayTracer;
 	WorkerSystem* workerSystem;
 	SceneManager* sceneManager;
 	PostProcessor* postProcessor;
+	Display* display;
 
 	// Move t
 	std::string screenshotPath = "Screenshots/";
 	std::string lastestScreenshotPath = "Screenshots/Latest/latest.png";
 
 	// Ray Tracing //
-	int sampleCount = 1;
-	int targetSampleCount = 100000;
 	Primitive* nearestPrimitive = nullptr;
 
 	// Window & Back Buffers // 
@@ -50,12 +52,13 @@ private:
 	unsigned int screenWidth;
 	unsigned int screenHeight;
 
-	vec3* sampleBuffer;
-	unsigned int* screenBuffer;
+	vec3* snapshotBuffer;
+	SurfaceFeatures* featureSnapshotBuffer;
 	unsigned int bufferSize;
 
 	// Actions To Take //
-	bool updateScreenBuffer = false;
+	bool screenOutdated = true; // New samples or post-processing settings that haven't been put on screen yet
+	bool snapshotConverged = false;
 	bool clearScreenBuffers = false;
 	bool resizeScreenBuffers = false;
 	bool takeScreenshot = false;
@@ -66,8 +69,8 @@ private:
 	std::chrono::milliseconds t0;
 	float* FPSLog;
 	float renderTime = 0.0f;
+	unsigned int frameCount = 0;
 	const int FPSLogSize = 30;
 
 	friend class Editor;
-	friend class WorkerSystem;
 };
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include "SceneManager.h"
 #include <fstream>
+#include <algorithm>
 #include <stb_image.h>
 #include <tinyexr.h>
 
+#include "Graphics/BVH.h"
 #include "Graphics/Camera.h"
 #include "Graphics/Textures/CheckerBoard.h"
 
@@ -13,6 +15,7 @@
 #include "Graphics/Triangle.h"
 
 #include "Utilities/LogHelper.h"
+#include "Utilities/Profiler.h"
 
 SceneManager::SceneManager(unsigned int screenWidth, unsigned int screenHeight)
 {
@@ -34,6 +37,7 @@ SceneManager::SceneManager(unsigned int screenWidth, unsigned int screenHeight)
 		activeScene = new Scene();
 		activeScene->Name = "Default";
 		activeScene->Camera = new Camera(screenWidth, screenHeight);
+		activeScene->BVH = new BVH();
 	}
 
 	// Replace with last loaded skydome // 
@@ -42,8 +46,27 @@ SceneManager::SceneManager(unsigned int screenWidth, unsigned int screenHeight)
 	LOG("Scene succesfully loaded!");
 }
 
+/// <summary>
+/// Loads 'scenePath' as is, for rendering without the editor. Nothing gets written back once done.
+/// The active scene stays null if the scene couldn't be loaded.
+/// </summary>
+SceneManager::SceneManager(const std::string& scenePath, const std::string& skydomePath, unsigned int screenWidth, unsigned int screenHeight) :
+	persistScene(false)
+{
+	if(LoadScene(scenePath, screenWidth, screenHeight))
+	{
+		LoadSkydome(skydomePath);
+		LOG("Scene succesfully loaded!");
+	}
+}
+
 SceneManager::~SceneManager()
 {
+	if(!persistScene || activeScene == nullptr)
+	{
+		return;
+	}
+
 	SaveScene();
 
 	std::ofstream lastScene;
@@ -56,6 +79,7 @@ SceneManager::~SceneManager()
 
 bool SceneManager::Update(float deltaTime)
 {
+	PROFILE_ZONE("Scene Update");
 	bool cameraUpdated = false;
 
 	if(!lockCameraMovement)
@@ -66,7 +90,7 @@ bool SceneManager::Update(float deltaTime)
 	return cameraUpdated || activeScene->HasUpdated;
 }
 
-void SceneManager::LoadScene(const std::string& sceneName, unsigned int screenWidth, unsigned int screenHeight)
+bool SceneManager::LoadScene(const std::string& sceneName, unsigned int screenWidth, unsigned int screenHeight)
 {
 	LOG("Loading Scene: '" + sceneName + "'");
 
@@ -76,7 +100,7 @@ void SceneManager::LoadScene(const std::string& sceneName, unsigned int screenWi
 	if(!scene.is_open())
 	{
 		LOG(Log::MessageType::Error, "Tried loading a scene that doesn't exist!");
-		return;
+		return false;
 	}
 
 	activeScene = new Scene();
@@ -199,12 +223,57 @@ void SceneManager::LoadScene(const std::string& sceneName, unsigned int screenWi
 
 		activeScene->primitives.push_back(primitive);
 	}
+
+	// Light Information //
+	// Older scene files end after the primitives, so lights are optional
+	if(std::getline(scene, line) && !line.empty())
+	{
+		int amountOfLights = std::stoi(line);
+
+		for(int i = 0; i < amountOfLights; i++)
+		{
+			Light light;
+
+			for(int j = 0; j < 3; j++)
+			{
+				std::getline(scene, line);
+				light.Position.data[j] = std::stof(line);
+			}
+
+			for(int j = 0; j < 3; j++)
+			{
+				std::getline(scene, line);
+				light.Color.data[j] = std::stof(line);
+			}
+
+			std::getline(scene, line);
+			light.Intensity = std::stof(line);
+
+			std::getline(scene, line);
+			light.HasArea = std::stoi(line);
+
+			for(int j = 0; j < 3; j++)
+			{
+				std::getline(scene, line);
+				light.Scale.data[j] = std::stof(line);
+			}
+
+			activeScene->Lights.push_back(light);
+		}
+	}
+
+	activeScene->BVH = new BVH();
+	activeScene->BVH->Build(activeScene->primitives);
+	UpdateEmissivePrimitives();
+
+	return true;
 }
 
 void SceneManager::LoadSkydome(const std::string& skydomePath)
 {
 	Skydome& sd = activeScene->Skydome;
 	delete sd.image;
+	sd.image = nullptr;
 
 	sd.Name = skydomePath;
 	const char* err = nullptr;
@@ -216,6 +285,9 @@ void SceneManager::LoadSkydome(const std::string& skydomePath)
 		fprintf(stderr, "ERR : %s\n", err);
 		FreeEXRErrorMessage(err);
 	}
+
+	// Only done once per load, the orientation gets applied when sampling //
+	sd.BuildDistribution();
 }
 
 void SceneManager::SaveScene()
@@ -297,6 +369,29 @@ void SceneManager::SaveScene()
 		sceneFile << activeScene->primitives[i]->Material.isDielectric << "\n";
 	}
 
+	// Light Information //
+	sceneFile << activeScene->Lights.size() << "\n";
+	for(const Light& light : activeScene->Lights)
+	{
+		for(int j = 0; j < 3; j++)
+		{
+			sceneFile << light.Position.data[j] << "\n";
+		}
+
+		for(int j = 0; j < 3; j++)
+		{
+			sceneFile << light.Color.data[j] << "\n";
+		}
+
+		sceneFile << light.Intensity << "\n";
+		sceneFile << light.HasArea << "\n";
+
+		for(int j = 0; j < 3; j++)
+		{
+			sceneFile << light.Scale.data[j] << "\n";
+		}
+	}
+
 	LOG("Scene succesfully saved!");
 }
 
@@ -308,15 +403,21 @@ void SceneManager::AddPrimitiveToScene(Primitive* primitive)
 /// <summary>
 /// Adds new primitives that where in the back buffer into the scene.
 /// Also removes all primitves that have been marked for delete.
+/// Whenever the primitives changed, the BVH gets rebuilt.
 /// </summary>
 void SceneManager::UpdateScene()
 {
+	PROFILE_ZONE("Scene Rebuild");
+	size_t primitiveCount = activeScene->primitives.size();
+
 	// Remove 'MarkedForDelete' primitives //
 	activeScene->primitives.erase(
 		std::remove_if(activeScene->primitives.begin(), activeScene->primitives.end(),
 			[](Primitive* primitive) { return primitive->MarkedForDelete; }),
 			activeScene->primitives.end());
 
+	bool rebuildBVH = primitiveCount != activeScene->primitives.size();
+
 	// Add back-buffered primitives //
 	if(primitiveBackBuffer.size() > 0)
 	{
@@ -326,6 +427,14 @@ void SceneManager::UpdateScene()
 		}
 
 		primitiveBackBuffer.clear();
+		rebuildBVH = true;
+	}
+
+	// 'HasUpdated' is set by the editor, which means a primitive might have been moved or scaled //
+	if(rebuildBVH || activeScene->HasUpdated)
+	{
+		activeScene->BVH->Build(activeScene->primitives);
+		UpdateEmissivePrimitives();
 	}
 
 	if(reloadSkydome)
@@ -337,6 +446,24 @@ void SceneManager::UpdateScene()
 	activeScene->HasUpdated = false;
 }
 
+/// <summary>
+/// Gathers the emissive primitives that can be sampled directly by the ray tracer.
+/// </summary>
+void SceneManager::UpdateEmissivePrimitives()
+{
+	activeScene->EmissivePrimitives.clear();
+
+	for(Primitive* primitive : activeScene->primitives)
+	{
+		bool canBeSampled = primitive->Type == PrimitiveType::Sphere || primitive->Type == PrimitiveType::Plane;
+
+		if(primitive->Material.isEmissive && canBeSampled)
+		{
+			activeScene->EmissivePrimitives.push_back(primitive);
+		}
+	}
+}
+
 Scene* SceneManager::GetActiveScene()
 {
 	return activeScene;
@@ -1,30 +1,27 @@
 #pragma once
 #include "Graphics/Primitive.h"
+#include "Graphics/Skydome.h"
 
 #include <vector>
 #include <string>
 
 class Camera;
-
-struct Skydome
-{
-	std::string Name = "Studio";
-	int width, height, comp;
-	float* image;
-
-	// Skydome //
-	float SkydomeOrientation = 0.0f;
-	float SkyDomeEmission = 1.0f;
-	float SkyDomeBackgroundStrength = 1.0f;
-};
+class BVH;
 
 struct Scene
 {
 	std::string Name;
 	std::vector<Primitive*> primitives;
+	std::vector<Light> Lights;
+
+	// Emissive spheres & planes, these get sampled directly alongside the 'Lights'
+	std::vector<Primitive*> EmissivePrimitives;
 
-	Camera* Camera;
-	Skydome Skydome;
+	::Camera* Camera;
+	::Skydome Skydome;
+
+	// Acceleration structure over 'primitives', rebuilt whenever they change
+	::BVH* BVH;
 
 	// Whenever the camera, skydome or any primitive in the scene
 	// gets updated, this flipped to notify that we need restart sampling
@@ -35,12 +32,13 @@ class SceneManager
 {
 public:
 	SceneManager(unsigned int screenWidth, unsigned int screenHeight);
+	SceneManager(const std::string& scenePath, const std::string& skydomePath, unsigned int screenWidth, unsigned int screenHeight);
 	~SceneManager();
 
 	bool Update(float deltaTime);
 
 	// Scene Serialization //
-	void LoadScene(const std::string& sceneName, unsigned int screenWidth, unsigned int screenHeight);
+	bool LoadScene(const std::string& sceneName, unsigned int screenWidth, unsigned int screenHeight);
 	void LoadSkydome(const std::string& skydomePath);
 	void SaveScene();
 
@@ -51,10 +49,14 @@ public:
 	Scene* GetActiveScene();
 
 private:
+	void UpdateEmissivePrimitives();
 
 private:
-	Scene* activeScene;
+	Scene* activeScene = nullptr;
 	std::string lastSceneSettings = "Scenes/scene.settings";
+
+	// Only the editor saves the scene it leaves behind, batch renders leave the files untouched //
+	bool persistScene = true;
 	std::vector<Primitive*> primitiveBackBuffer;
 
 	bool lockCameraMovement = false;
@@ -1,62 +1,111 @@
 #include "WorkerSystem.h"
-#include "Framework/Renderer.h"
+#include "Framework/RenderContext.h"
 #include "Graphics/RayTracer.h"
+#include "Graphics/TraceStats.h"
 
 #include "Utilities/Utilities.h"
+#include "Utilities/Profiler.h"
+#include <climits>
 
-WorkerSystem::WorkerSystem(Renderer* renderer, unsigned int screenWidth, unsigned int screenHeight) :
+WorkerSystem::WorkerSystem(RenderContext* renderer, unsigned int screenWidth, unsigned int screenHeight) :
 	renderer(renderer), screenWidth(screenWidth), screenHeight(screenHeight)
 {
 	LOG("Retrieving thread count...");
-	threadsAvailable = std::thread::hardware_concurrency();
+	// 'hardware_concurrency' returns 0 when it can't tell, there's always at least one thread to work on //
+	threadsAvailable = max((int)std::thread::hardware_concurrency(), 1);
+	threadCount = threadsAvailable;
+	busyWorkers = 0;
+	isPaused = false;
+	convergedTiles = 0;
+	convergedPixels = 0;
+	parallelNext = 0;
+	parallelFinished = 0;
+	parallelHelpers = 0;
+	parallelJobActive = false;
 
-	threads = new std::thread[threadsAvailable];
 	LOG("There are: '" + std::to_string(threadsAvailable) + "' threads available for use.");
 
 	ResizeJobTiles(screenWidth, screenHeight);
-	workIndex.store(jobTiles.size() - 1);
-
-	for(int i = 0; i < threadsAvailable; i++)
-	{
-		threads[i] = std::thread([this] { Work(); });
-	}
+	StartThreads();
+	NotifyWorkers();
 
 	LOG("Multi-threading succesfully started.");
 }
 
+WorkerSystem::~WorkerSystem()
+{
+	StopThreads();
+	delete[] tileLocks;
+}
+
 void WorkerSystem::Update()
 {
-	if(workIndex < 0)
+	// All tiles have been traced, which means an iteration has been completed
+	// and we can update the screen buffer
+	if(tilesRemaining.load() <= 0)
+	{
+		renderer->updateScreenBuffer = true;
+	}
+}
+
+void WorkerSystem::NotifyWorkers()
+{
+	// Has to be set before any tile becomes available, since a worker
+	// that is still finishing up could pick up a tile right away.
+	unsigned int tileCount = jobTiles.size();
+	tilesRemaining.store(tileCount - convergedTiles.load());
+	isPaused = false;
+
+	// Every thread gets a contiguous band of tiles, which keeps neighbouring
+	// pixels (and the part of the scene they hit) on the same core.
+	for(int i = 0; i < threadCount; i++)
 	{
-		// All jobs have been picked up, check if they are done as well
-		// if so, that means an trace iteration has been completed, and we can
-		// update the screen buffer
-		bool iterationDone = true;
+		unsigned int first = (tileCount * i) / threadCount;
+		unsigned int last = (tileCount * (i + 1)) / threadCount;
+
+		std::lock_guard<std::mutex> lock(workQueues[i].Lock);
+		workQueues[i].Tiles.clear();
 
-		for(unsigned int i = 0; i < jobTiles.size(); i++)
+		for(unsigned int tile = first; tile < last; tile++)
 		{
-			if(jobTiles[i].State != JobState::Done)
+			if(!jobTiles[tile].Converged)
 			{
-				iterationDone = false;
+				workQueues[i].Tiles.push_back(tile);
 			}
 		}
+	}
 
-		if(iterationDone)
-		{
-			renderer->updateScreenBuffer = true;
-		}
+	{
+		std::lock_guard<std::mutex> lock(iterationLock);
+		iteration++;
 	}
+
+	iterationSignal.notify_all();
 }
 
-void WorkerSystem::NotifyWorkers()
+/// <summary>
+/// Blocks until every tile of the current (non-asynchronous) iteration has been traced.
+/// For callers without a frame loop, which would otherwise have to poll 'Update'.
+/// </summary>
+void WorkerSystem::WaitForIteration()
+{
+	std::unique_lock<std::mutex> lock(iterationLock);
+	iterationFinishedSignal.wait(lock, [&] { return tilesRemaining.load() <= 0; });
+}
+
+/// <summary>
+/// Stops workers from picking up new tiles, and waits until all of them
+/// are out of their current tile. Afterwards the sample buffer and tiles can
+/// be safely modified, 'NotifyWorkers' resumes the work.
+/// </summary>
+void WorkerSystem::Pause()
 {
-	for(unsigned int i = 0; i < jobTiles.size(); i++)
+	isPaused = true;
+
+	while(busyWorkers.load() > 0)
 	{
-		jobTiles[i].State = JobState::ToDo;
+		std::this_thread::yield();
 	}
-
-	workIndex.store(jobTiles.size() - 1);
-	iterationLock.notify_all();
 }
 
 void WorkerSystem::ResizeJobTiles(unsigned int screenWidth, unsigned int screenHeight)
@@ -66,58 +115,503 @@ void WorkerSystem::ResizeJobTiles(unsigned int screenWidth, unsigned int screenH
 
 	jobTiles.clear();
 
-	int horizontalTiles = screenWidth / tileSize;
-	int verticalTiles = screenHeight / tileSize;
+	convergedTiles = 0;
+	convergedPixels = 0;
 
-	for(unsigned int y = 0; y < verticalTiles; y++)
+	// Tiles along the right & top edge get cut off when the screen isn't a multiple of the tile size //
+	for(unsigned int y = 0; y < screenHeight; y += tileSize)
 	{
-		for(unsigned int x = 0; x < horizontalTiles; x++)
+		for(unsigned int x = 0; x < screenWidth; x += tileSize)
 		{
 			JobTile tile;
-			tile.x = x * tileSize;
-			tile.y = y * tileSize;
-			tile.xMax = x * tileSize + tileSize;
-			tile.yMax = y * tileSize + tileSize;
+			tile.x = x;
+			tile.y = y;
+			tile.xMax = min(x + tileSize, screenWidth);
+			tile.yMax = min(y + tileSize, screenHeight);
 
 			jobTiles.push_back(tile);
 		}
 	}
+
+	delete[] tileLocks;
+	tileLocks = new std::mutex[jobTiles.size()];
+}
+
+/// <summary>
+/// Restarts the workers with a different amount of threads.
+/// The current iteration gets traced again from the start.
+/// </summary>
+void WorkerSystem::SetThreadCount(int threadCount)
+{
+	StopThreads();
+
+	this->threadCount = Clamp(threadCount, 1, threadsAvailable * 4);
+	LOG("Restarting workers with '" + std::to_string(this->threadCount) + "' threads.");
+
+	StartThreads();
+	NotifyWorkers();
+}
+
+void WorkerSystem::SetTileSize(unsigned int tileSize)
+{
+	StopThreads();
+
+	this->tileSize = max(tileSize, 1u);
+	ResizeJobTiles(screenWidth, screenHeight);
+
+	StartThreads();
+	NotifyWorkers();
+}
+
+void WorkerSystem::SetAsynchronous(bool asynchronous)
+{
+	Pause();
+	this->asynchronous = asynchronous;
+
+	LOG(asynchronous ? "Switched to asynchronous accumulation." : "Switched to per-sample accumulation.");
+	NotifyWorkers();
+}
+
+bool WorkerSystem::IsAsynchronous()
+{
+	return asynchronous;
+}
+
+void WorkerSystem::ClearTileSamples()
+{
+	for(JobTile& tile : jobTiles)
+	{
+		tile.SampleCount = 0;
+		tile.SamplesStarted = 0;
+		tile.Error = 0.0f;
+		tile.Converged = false;
+	}
+
+	convergedTiles = 0;
+	convergedPixels = 0;
+}
+
+/// <summary>
+/// Copies the averaged samples of every tile into 'destination', and their averaged
+/// surface features into 'featureDestination'. Every tile is
+/// locked while it's copied, so a tile never shows a half committed sample.
+/// Returns the lowest sample count across all tiles.
+/// </summary>
+unsigned int WorkerSystem::TakeSnapshot(vec3* destination, SurfaceFeatures* featureDestination)
+{
+	PROFILE_ZONE("Snapshot");
+	unsigned int minimumSampleCount = UINT_MAX;
+
+	for(unsigned int t = 0; t < jobTiles.size(); t++)
+	{
+		const JobTile& tile = jobTiles[t];
+		std::lock_guard<std::mutex> lock(tileLocks[t]);
+
+		float sampleINV = tile.SampleCount > 0 ? 1.0f / tile.SampleCount : 0.0f;
+		minimumSampleCount = min(minimumSampleCount, tile.SampleCount);
+
+		for(unsigned int y = tile.y; y < tile.yMax; y++)
+		{
+			for(unsigned int x = tile.x; x < tile.xMax; x++)
+			{
+				int i = x + y * screenWidth;
+				destination[i] = renderer->sampleBuffer[i] * sampleINV;
+
+				const SurfaceFeatures& features = renderer->featureBuffer[i];
+				featureDestination[i].Albedo = features.Albedo * sampleINV;
+				featureDestination[i].Normal = features.Normal * sampleINV;
+				featureDestination[i].Depth = features.Depth * sampleINV;
+			}
+		}
+	}
+
+	return jobTiles.empty() ? 0 : minimumSampleCount;
+}
+
+/// <summary>
+/// True once adaptive sampling stopped tracing every tile.
+/// </summary>
+bool WorkerSystem::IsConverged()
+{
+	return useAdaptiveSampling.load() && !jobTiles.empty() && convergedTiles.load() >= jobTiles.size();
+}
+
+float WorkerSystem::GetConvergedPercentage()
+{
+	unsigned int pixelCount = max(screenWidth * screenHeight, 1u);
+	return convergedPixels.load() / float(pixelCount) * 100.0f;
+}
+
+void WorkerSystem::ParallelFor(unsigned int count, const std::function<void(unsigned int)>& function)
+{
+	if(count == 0)
+	{
+		return;
+	}
+
+	parallelFunction = function;
+	parallelCount = count;
+	parallelNext = 0;
+	parallelFinished = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(iterationLock);
+		parallelJobActive = true;
+	}
+
+	iterationSignal.notify_all();
+
+	// The calling thread helps out as well, so this also works without any workers //
+	RunParallelJob();
+
+	while(parallelFinished.load() < count)
+	{
+		std::this_thread::yield();
+	}
+
+	parallelJobActive = false;
+
+	while(parallelHelpers.load() > 0)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void WorkerSystem::RunParallelJob()
+{
+	if(!parallelJobActive.load())
+	{
+		return;
+	}
+
+	parallelHelpers++;
+
+	if(parallelJobActive.load())
+	{
+		unsigned int index;
+		while((index = parallelNext.fetch_add(1)) < parallelCount)
+		{
+			parallelFunction(index);
+			parallelFinished++;
+		}
+	}
+
+	parallelHelpers--;
+}
+
+void WorkerSystem::StartThreads()
+{
+	isRunning = true;
+	threads = new std::thread[threadCount];
+	workQueues = new WorkQueue[threadCount];
+
+	unsigned int startIteration;
+	{
+		std::lock_guard<std::mutex> lock(iterationLock);
+		startIteration = iteration;
+	}
+
+	for(int i = 0; i < threadCount; i++)
+	{
+		threads[i] = std::thread([this, i, startIteration] { Work(i, startIteration); });
+	}
+}
+
+void WorkerSystem::StopThreads()
+{
+	if(!threads)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(iterationLock);
+		isRunning = false;
+	}
+
+	iterationSignal.notify_all();
+
+	for(int i = 0; i < threadCount; i++)
+	{
+		threads[i].join();
+	}
+
+	delete[] threads;
+	delete[] workQueues;
+	threads = nullptr;
+	workQueues = nullptr;
+}
+
+void WorkerSystem::Work(int threadIndex, unsigned int startIteration)
+{
+	Profiler::SetThreadName("Worker " + std::to_string(threadIndex));
+
+	unsigned int lastIteration = startIteration;
+	std::vector<vec3> tileSamples(tileSize * tileSize);
+	std::vector<SurfaceFeatures> tileFeatures(tileSize * tileSize);
+
+	while(true)
+	{
+		// Wait until a new iteration gets started, or a parallel job comes in //
+		{
+			std::unique_lock<std::mutex> lock(iterationLock);
+			iterationSignal.wait(lock, [&] { return !isRunning || iteration != lastIteration || parallelJobActive; });
+
+			if(!isRunning)
+			{
+				return;
+			}
+
+			if(iteration == lastIteration)
+			{
+				lock.unlock();
+				RunParallelJob();
+				std::this_thread::yield();
+				continue;
+			}
+
+			lastIteration = iteration;
+		}
+
+		while(isRunning)
+		{
+			RunParallelJob();
+
+			// Marked as busy before checking for a pause, so 'Pause' can never miss us //
+			busyWorkers++;
+
+			unsigned int tileIndex;
+			bool hasWork = !isPaused && GetTile(threadIndex, tileIndex);
+
+			// In asynchronous mode there is no end to an iteration, once all the queues
+			// are empty the next pass over the unfinished tiles gets queued up right away.
+			if(!hasWork && asynchronous && !isPaused && RefillQueues())
+			{
+				hasWork = GetTile(threadIndex, tileIndex);
+			}
+
+			if(hasWork)
+			{
+				if(asynchronous)
+				{
+					TraceTileAsynchronous(tileIndex, tileSamples, tileFeatures);
+				}
+				else
+				{
+					TraceTile(tileIndex);
+
+					// Taking the lock makes sure a waiting thread can't miss the signal //
+					if(tilesRemaining.fetch_sub(1) == 1)
+					{
+						std::lock_guard<std::mutex> lock(iterationLock);
+						iterationFinishedSignal.notify_all();
+					}
+				}
+			}
+
+			busyWorkers--;
+
+			if(!hasWork)
+			{
+				break;
+			}
+		}
+	}
 }
 
-void WorkerSystem::Work()
+bool WorkerSystem::GetTile(int threadIndex, unsigned int& tileIndex)
 {
-	while(isRunning)
+	// Take work from the back of our own queue first //
 	{
-		// Retrieve job tile index
-		int index = workIndex.fetch_sub(1);
+		WorkQueue& queue = workQueues[threadIndex];
+		std::lock_guard<std::mutex> lock(queue.Lock);
 
-		// All jobs available are either in process or have been completed
-		// Wait until you receive a signal to continue again.
-		if(index < 0)
+		if(!queue.Tiles.empty())
 		{
-			std::unique_lock<std::mutex> lock(rayLock);
-			iterationLock.wait(lock);
-			continue;
+			tileIndex = queue.Tiles.back();
+			queue.Tiles.pop_back();
+			return true;
 		}
+	}
 
-		JobTile& tile = jobTiles[index];
+	// Out of work, steal from the front of the other threads their queues //
+	for(int i = 1; i < threadCount; i++)
+	{
+		WorkQueue& victim = workQueues[(threadIndex + i) % threadCount];
+		std::lock_guard<std::mutex> lock(victim.Lock);
 
-		if(tile.State != JobState::ToDo)
+		if(!victim.Tiles.empty())
 		{
-			continue;
+			tileIndex = victim.Tiles.front();
+			victim.Tiles.pop_front();
+			return true;
 		}
+	}
+
+	return false;
+}
+
+/// <summary>
+/// Queues up another sample for every tile that hasn't reached the target sample count.
+/// Returns false if every tile is done.
+/// </summary>
+bool WorkerSystem::RefillQueues()
+{
+	std::lock_guard<std::mutex> refill(refillLock);
+
+	unsigned int targetSampleCount = renderer->targetSampleCount;
+	unsigned int tileCount = jobTiles.size();
+	bool queuedWork = false;
+
+	for(int i = 0; i < threadCount; i++)
+	{
+		unsigned int first = (tileCount * i) / threadCount;
+		unsigned int last = (tileCount * (i + 1)) / threadCount;
 
-		tile.State = JobState::Processing;
+		std::lock_guard<std::mutex> lock(workQueues[i].Lock);
 
-		for(int x = tile.x; x < tile.xMax; x++)
+		for(unsigned int tile = first; tile < last; tile++)
 		{
-			for(int y = tile.y; y < tile.yMax; y++)
+			if(jobTiles[tile].SamplesStarted < targetSampleCount && !jobTiles[tile].Converged)
 			{
-				int i = x + y * screenWidth;
-				renderer->sampleBuffer[i] += renderer->rayTracer->Trace(x, y);
+				workQueues[i].Tiles.push_back(tile);
+				queuedWork = true;
+			}
+		}
+	}
+
+	return queuedWork;
+}
+
+void WorkerSystem::TraceTile(unsigned int tileIndex)
+{
+	PROFILE_ZONE("Trace Tile");
+	JobTile& tile = jobTiles[tileIndex];
+
+	// Every other sample also goes into the half buffer //
+	bool isHalfSample = tile.SampleCount % 2 == 0;
+
+	for(unsigned int y = tile.y; y < tile.yMax; y++)
+	{
+		for(unsigned int x = tile.x; x < tile.xMax; x++)
+		{
+			int i = x + y * screenWidth;
+			SurfaceFeatures features;
+			vec3 sample = renderer->rayTracer->Trace(x, y, renderer->sampleCount, features);
+			renderer->sampleBuffer[i] += sample;
+			renderer->featureBuffer[i] += features;
+
+			if(isHalfSample)
+			{
+				renderer->halfSampleBuffer[i] += sample;
+			}
+		}
+	}
+
+	// Before committing, so the counters are complete once the iteration is //
+	TraceStats::Flush();
+
+	std::lock_guard<std::mutex> lock(tileLocks[tileIndex]);
+	CommitTileSample(tile);
+}
+
+void WorkerSystem::TraceTileAsynchronous(unsigned int tileIndex, std::vector<vec3>& tileSamples, std::vector<SurfaceFeatures>& tileFeatures)
+{
+	JobTile& tile = jobTiles[tileIndex];
+	unsigned int sampleIndex;
+
+	// Reserve a sample index, tiles can be in flight on multiple threads at once //
+	{
+		std::lock_guard<std::mutex> lock(tileLocks[tileIndex]);
+
+		if(tile.SamplesStarted >= (unsigned int)renderer->targetSampleCount || tile.Converged)
+		{
+			return;
+		}
+
+		tile.SamplesStarted++;
+		sampleIndex = tile.SamplesStarted;
+	}
+
+	// Trace outside of the lock, so snapshots are never blocked for long //
+	PROFILE_ZONE("Trace Tile");
+	unsigned int tileWidth = tile.xMax - tile.x;
+	for(unsigned int y = tile.y; y < tile.yMax; y++)
+	{
+		for(unsigned int x = tile.x; x < tile.xMax; x++)
+		{
+			unsigned int local = (x - tile.x) + (y - tile.y) * tileWidth;
+			tileSamples[local] = renderer->rayTracer->Trace(x, y, sampleIndex, tileFeatures[local]);
+		}
+	}
+
+	TraceStats::Flush();
+
+	std::lock_guard<std::mutex> lock(tileLocks[tileIndex]);
+	bool isHalfSample = tile.SampleCount % 2 == 0;
+
+	for(unsigned int y = tile.y; y < tile.yMax; y++)
+	{
+		for(unsigned int x = tile.x; x < tile.xMax; x++)
+		{
+			int i = x + y * screenWidth;
+			unsigned int local = (x - tile.x) + (y - tile.y) * tileWidth;
+			vec3 sample = tileSamples[local];
+			renderer->sampleBuffer[i] += sample;
+			renderer->featureBuffer[i] += tileFeatures[local];
+
+			if(isHalfSample)
+			{
+				renderer->halfSampleBuffer[i] += sample;
 			}
 		}
+	}
+
+	CommitTileSample(tile);
+}
+
+/// <summary>
+/// Counts the sample that just got added to 'tile', and with adaptive sampling, checks whether the tile converged.
+/// The error compares the average of all samples against the average of only the 'half' samples, relative to
+/// the square root of the brightness, so dark pixels aren't held to the same absolute error as bright ones.
+/// Based on Dammertz et al. 2010, "A Hierarchical Automatic Stopping Condition for Monte Carlo Global Illumination".
+/// Has to be called while holding the lock of 'tile'.
+/// </summary>
+void WorkerSystem::CommitTileSample(JobTile& tile)
+{
+	tile.SampleCount++;
+
+	if(!useAdaptiveSampling.load() || tile.Converged || tile.SampleCount < adaptiveMinSamples.load())
+	{
+		return;
+	}
+
+	float sampleINV = 1.0f / tile.SampleCount;
+	float halfSampleINV = 1.0f / ((tile.SampleCount + 1) / 2);
+	float error = 0.0f;
+
+	for(unsigned int y = tile.y; y < tile.yMax; y++)
+	{
+		for(unsigned int x = tile.x; x < tile.xMax; x++)
+		{
+			int i = x + y * screenWidth;
+			vec3 full = renderer->sampleBuffer[i] * sampleINV;
+			vec3 half = renderer->halfSampleBuffer[i] * halfSampleINV;
+			vec3 difference = full - half;
+
+			float absoluteDifference = fabsf(difference.x) + fabsf(difference.y) + fabsf(difference.z);
+			float brightness = full.x + full.y + full.z;
+			error += absoluteDifference / sqrtf(brightness + 0.0001f);
+		}
+	}
 
-		tile.State = JobState::Done;
+	unsigned int pixelCount = (tile.xMax - tile.x) * (tile.yMax - tile.y);
+	tile.Error = error / pixelCount;
+
+	if(tile.Error < adaptiveThreshold.load())
+	{
+		tile.Converged = true;
+		convergedTiles++;
+		convergedPixels += pixelCount;
 	}
-}
\ No newline at end of file
+}
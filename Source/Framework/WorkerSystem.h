@@ -1,5 +1,7 @@
 #pragma once
 #include <vector>
+#include <deque>
+#include <functional>
 
 // Multi-threading //
 #include <thread>
@@ -7,50 +9,131 @@
 #include <mutex>
 #include <condition_variable>
 
-class Renderer;
+#include "Math/Vec3.h"
+#include "Graphics/SurfaceFeatures.h"
 
-enum class JobState
-{
-	ToDo,
-	Processing,
-	Done
-};
+class RenderContext;
 
 struct JobTile
 {
-	JobState State = JobState::ToDo;
-
 	unsigned int x;
 	unsigned int y;
 	unsigned int xMax;
 	unsigned int yMax;
+
+	// Every tile progresses on its own, 'SamplesStarted' is only used with asynchronous accumulation //
+	unsigned int SampleCount = 0;
+	unsigned int SamplesStarted = 0;
+
+	// Adaptive Sampling //
+	// Once the error drops below the threshold, the tile doesn't get traced again
+	float Error = 0.0f;
+	bool Converged = false;
+};
+
+/// <summary>
+/// Every thread owns a queue of tile indices. Threads take work from the back
+/// of their own queue, and once that runs dry, steal from the front of others.
+/// Aligned to a cache line, so threads don't contend when locking their own queue.
+/// </summary>
+struct alignas(64) WorkQueue
+{
+	std::deque<unsigned int> Tiles;
+	std::mutex Lock;
 };
 
 class WorkerSystem
 {
 public:
-	WorkerSystem(Renderer* renderer, unsigned int screenWidth, unsigned int screenHeight);
+	WorkerSystem(RenderContext* renderer, unsigned int screenWidth, unsigned int screenHeight);
+	~WorkerSystem();
 
 	void Update();
 	void NotifyWorkers();
+	void WaitForIteration();
+	void Pause();
 
 	void ResizeJobTiles(unsigned int screenWidth, unsigned int screenHeight);
+	void SetThreadCount(int threadCount);
+	void SetTileSize(unsigned int tileSize);
+
+	// Asynchronous Accumulation //
+	void SetAsynchronous(bool asynchronous);
+	bool IsAsynchronous();
+	void ClearTileSamples();
+	unsigned int TakeSnapshot(vec3* destination, SurfaceFeatures* featureDestination);
+
+	// Adaptive Sampling //
+	bool IsConverged();
+	float GetConvergedPercentage();
+
+	// Runs 'function' for every index in [0, count), spread over the workers and the calling thread.
+	// Returns once every index is done. Only to be called from the main thread.
+	void ParallelFor(unsigned int count, const std::function<void(unsigned int)>& function);
 
 private:
-	void Work();
+	void StartThreads();
+	void StopThreads();
+
+	void Work(int threadIndex, unsigned int startIteration);
+	bool GetTile(int threadIndex, unsigned int& tileIndex);
+	bool RefillQueues();
+	void RunParallelJob();
+
+	void TraceTile(unsigned int tileIndex);
+	void TraceTileAsynchronous(unsigned int tileIndex, std::vector<vec3>& tileSamples, std::vector<SurfaceFeatures>& tileFeatures);
+	void CommitTileSample(JobTile& tile);
 
 private:
 	unsigned int screenWidth;
 	unsigned int screenHeight;
 
-	Renderer* renderer;
-	bool isRunning = true;
+	RenderContext* renderer;
+	std::atomic<bool> isRunning;
+	std::atomic<bool> isPaused;
+	std::atomic<int> busyWorkers;
 
 	int threadsAvailable;
+	int threadCount;
 	unsigned int tileSize = 8;
-	std::thread* threads;
+	std::thread* threads = nullptr;
+	WorkQueue* workQueues = nullptr;
+
 	std::vector<JobTile> jobTiles;
-	std::atomic<int> workIndex;
-	std::condition_variable iterationLock;
-	std::mutex rayLock;
-};
\ No newline at end of file
+	std::atomic<int> tilesRemaining;
+
+	// A new iteration gets started by incrementing 'iteration',
+	// workers sleep until they see it change.
+	unsigned int iteration = 0;
+	std::condition_variable iterationSignal;
+	std::condition_variable iterationFinishedSignal;
+	std::mutex iterationLock;
+
+	// Without a barrier between samples, workers keep tracing tiles and
+	// commit every finished tile sample under that tile its lock.
+	bool asynchronous = false;
+	std::mutex* tileLocks = nullptr;
+	std::mutex refillLock;
+
+	// Tiles stop getting traced once their error estimate, from comparing the full
+	// accumulation against 'halfSampleBuffer' (every other sample), is below 'adaptiveThreshold'.
+	// Atomic, since the editor changes them while (asynchronous) workers are committing samples.
+	std::atomic<bool> useAdaptiveSampling{ true };
+	std::atomic<float> adaptiveThreshold{ 0.01f };
+	std::atomic<unsigned int> adaptiveMinSamples{ 64 };
+	std::atomic<unsigned int> convergedTiles;
+	std::atomic<unsigned int> convergedPixels;
+
+	// Parallel For //
+	// Workers check for a job in between tiles, or get woken up for it when idle.
+	// 'parallelHelpers' keeps the job alive until every worker that joined has left.
+	std::function<void(unsigned int)> parallelFunction;
+	unsigned int parallelCount = 0;
+	std::atomic<unsigned int> parallelNext;
+	std::atomic<unsigned int> parallelFinished;
+	std::atomic<int> parallelHelpers;
+	std::atomic<bool> parallelJobActive;
+
+	friend class Editor;
+	friend class BatchRenderer;
+};
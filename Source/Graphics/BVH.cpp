@@ -0,0 +1,759 @@
+#include "BVH.h"
+#include "Sphere.h"
+#include "Plane.h"
+#include "PlaneInfinite.h"
+#include "Triangle.h"
+#include "TraceStats.h"
+#include <cmath>
+#include <climits>
+#include <immintrin.h>
+
+// Sphere packet lanes //
+// Spheres get tested 8 at a time with AVX2, and 4 at a time with SSE otherwise.
+// Both share the same kernel through these small wrappers.
+#if defined(__AVX2__)
+typedef __m256 Lanes;
+const int BVH::sphereLanes = 8;
+
+static inline Lanes Set1(float v) { return _mm256_set1_ps(v); }
+static inline Lanes Load(const float* v) { return _mm256_loadu_ps(v); }
+static inline void Store(float* destination, Lanes v) { _mm256_storeu_ps(destination, v); }
+static inline Lanes LaneOffsets() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+static inline Lanes Add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+static inline Lanes Sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+static inline Lanes Mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+static inline Lanes Sqrt(Lanes a) { return _mm256_sqrt_ps(a); }
+static inline Lanes Max(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+static inline Lanes Less(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline Lanes LessEqual(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline Lanes And(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+static inline Lanes Select(Lanes mask, Lanes a, Lanes b) { return _mm256_blendv_ps(b, a, mask); }
+static inline bool Any(Lanes mask) { return _mm256_movemask_ps(mask) != 0; }
+#else
+typedef __m128 Lanes;
+const int BVH::sphereLanes = 4;
+
+static inline Lanes Set1(float v) { return _mm_set1_ps(v); }
+static inline Lanes Load(const float* v) { return _mm_loadu_ps(v); }
+static inline void Store(float* destination, Lanes v) { _mm_storeu_ps(destination, v); }
+static inline Lanes LaneOffsets() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+static inline Lanes Add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+static inline Lanes Sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+static inline Lanes Mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+static inline Lanes Sqrt(Lanes a) { return _mm_sqrt_ps(a); }
+static inline Lanes Max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+static inline Lanes Less(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+static inline Lanes LessEqual(Lanes a, Lanes b) { return _mm_cmple_ps(a, b); }
+static inline Lanes And(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+static inline Lanes Select(Lanes mask, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline bool Any(Lanes mask) { return _mm_movemask_ps(mask) != 0; }
+#endif
+
+// A ray broadcast to every lane //
+struct RayLanes
+{
+	Lanes OriginX, OriginY, OriginZ;
+	Lanes DirectionX, DirectionY, DirectionZ;
+};
+
+static inline RayLanes BroadcastRay(const Ray& ray)
+{
+	RayLanes lanes;
+	lanes.OriginX = Set1(ray.Origin.x);
+	lanes.OriginY = Set1(ray.Origin.y);
+	lanes.OriginZ = Set1(ray.Origin.z);
+	lanes.DirectionX = Set1(ray.Direction.x);
+	lanes.DirectionY = Set1(ray.Direction.y);
+	lanes.DirectionZ = Set1(ray.Direction.z);
+	return lanes;
+}
+
+/// <summary>
+/// Distance along the ray to a packet of spheres, 'valid' marks the lanes that got hit.
+/// Rays that start inside of a sphere without being marked as inside a medium get the far side,
+/// which is how refracted rays exit. Those lanes get marked in 'inside'.
+/// </summary>
+static inline Lanes SphereDistances(const RayLanes& ray, const float* x, const float* y, const float* z, const float* radius2,
+	bool insideMedium, Lanes& valid, Lanes& inside)
+{
+	const Lanes zero = Set1(0.0f);
+
+	Lanes toCenterX = Sub(Load(x), ray.OriginX);
+	Lanes toCenterY = Sub(Load(y), ray.OriginY);
+	Lanes toCenterZ = Sub(Load(z), ray.OriginZ);
+	Lanes r2 = Load(radius2);
+
+	// Squared distance between the sphere center and the closest point along the ray //
+	Lanes projection = Add(Add(Mul(toCenterX, ray.DirectionX), Mul(toCenterY, ray.DirectionY)), Mul(toCenterZ, ray.DirectionZ));
+	Lanes offsetX = Sub(toCenterX, Mul(ray.DirectionX, projection));
+	Lanes offsetY = Sub(toCenterY, Mul(ray.DirectionY, projection));
+	Lanes offsetZ = Sub(toCenterZ, Mul(ray.DirectionZ, projection));
+	Lanes distance2 = Add(Add(Mul(offsetX, offsetX), Mul(offsetY, offsetY)), Mul(offsetZ, offsetZ));
+
+	valid = LessEqual(distance2, r2);
+	inside = zero;
+
+	Lanes insideLength = Sqrt(Max(Sub(r2, distance2), zero));
+	Lanes t = Sub(projection, insideLength);
+
+	if(!insideMedium)
+	{
+		inside = Less(t, zero);
+		t = Select(inside, Add(projection, projection), t);
+	}
+
+	return t;
+}
+
+// Statistics //
+#if USE_TRACE_STATS
+static inline void CountPrimitiveTest(TraceStats& stats, PrimitiveType type)
+{
+	if(type == PrimitiveType::Triangle)
+	{
+		stats.TriangleTests++;
+	}
+	else
+	{
+		stats.PlaneTests++;
+	}
+}
+#endif
+
+// Slab test, returns the distance to the box or 'FLT_MAX' on a miss //
+static inline float IntersectAABB(const Ray& ray, const vec3& invDirection, const AABB& bounds, float maxT)
+{
+	float tx1 = (bounds.Min.x - ray.Origin.x) * invDirection.x;
+	float tx2 = (bounds.Max.x - ray.Origin.x) * invDirection.x;
+	float tMin = fminf(tx1, tx2);
+	float tMax = fmaxf(tx1, tx2);
+
+	float ty1 = (bounds.Min.y - ray.Origin.y) * invDirection.y;
+	float ty2 = (bounds.Max.y - ray.Origin.y) * invDirection.y;
+	tMin = fmaxf(tMin, fminf(ty1, ty2));
+	tMax = fminf(tMax, fmaxf(ty1, ty2));
+
+	float tz1 = (bounds.Min.z - ray.Origin.z) * invDirection.z;
+	float tz2 = (bounds.Max.z - ray.Origin.z) * invDirection.z;
+	tMin = fmaxf(tMin, fminf(tz1, tz2));
+	tMax = fminf(tMax, fmaxf(tz1, tz2));
+
+	if(tMax >= tMin && tMin < maxT && tMax > 0.0f)
+	{
+		return tMin;
+	}
+
+	return FLT_MAX;
+}
+
+void BVH::Build(const std::vector<Primitive*>& scenePrimitives)
+{
+	primitives.clear();
+	unboundedPrimitives.clear();
+	primitiveIndices.clear();
+	primitiveBounds.clear();
+	primitiveCentroids.clear();
+	nodes.clear();
+	nodesUsed = 0;
+
+	for(Primitive* primitive : scenePrimitives)
+	{
+		// Infinite planes would stretch the bounds of the whole tree //
+		if(primitive->Type == PrimitiveType::PlaneInfinite)
+		{
+			unboundedPrimitives.push_back(primitive);
+			continue;
+		}
+
+		AABB bounds = primitive->GetBounds();
+
+		primitiveIndices.push_back(primitives.size());
+		primitives.push_back(primitive);
+		primitiveBounds.push_back(bounds);
+		primitiveCentroids.push_back(bounds.Center());
+	}
+
+	if(primitives.empty())
+	{
+		BuildPrimitiveData();
+		return;
+	}
+
+	// A binary tree with N leaves never exceeds 2N - 1 nodes //
+	nodes.resize(primitives.size() * 2 - 1);
+
+	BVHNode& root = nodes[0];
+	root.LeftFirst = 0;
+	root.PrimitiveCount = primitives.size();
+	nodesUsed = 1;
+
+	UpdateNodeBounds(0);
+	Subdivide(0, 0);
+
+	BuildPrimitiveData();
+}
+
+void BVH::Intersect(const Ray& ray, HitRecord& record)
+{
+	const bool insideMedium = record.InsideMedium;
+
+	ClosestHit hit;
+	hit.t = record.t;
+	hit.Slot = UINT_MAX;
+
+	TRACE_STAT(TraceStats::Local().PlaneTests += unboundedPrimitives.size());
+	for(unsigned int i = 0; i < unboundedPrimitives.size(); i++)
+	{
+		IntersectSlot(primitiveIndices.size() + i, ray, hit, insideMedium);
+	}
+
+	if(nodesUsed > 0)
+	{
+		Traverse(ray, hit, insideMedium);
+	}
+
+	if(hit.Slot != UINT_MAX)
+	{
+		ReconstructSurface(ray, hit, record);
+	}
+}
+
+/// <summary>
+/// Any-hit query, returns true as soon as anything is found between
+/// EPSILON and 'tMax' along the ray. Meant for shadow rays.
+/// </summary>
+bool BVH::Occluded(const Ray& ray, float tMax)
+{
+	TRACE_STAT(TraceStats& stats = TraceStats::Local());
+	TRACE_STAT(stats.ShadowRays++);
+
+	float u, v;
+	for(unsigned int i = 0; i < unboundedPrimitives.size(); i++)
+	{
+		TRACE_STAT(stats.PlaneTests++);
+		float t = SlotDistance(primitiveIndices.size() + i, ray, u, v);
+
+		if(t > EPSILON && t < tMax)
+		{
+			TRACE_STAT(stats.OccludedShadowRays++);
+			return true;
+		}
+	}
+
+	if(nodesUsed == 0)
+	{
+		return false;
+	}
+
+	vec3 invDirection = vec3(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+
+	unsigned int stack[stackSize];
+	unsigned int stackPointer = 0;
+	bool occluded = false;
+
+	if(IntersectAABB(ray, invDirection, nodes[0].Bounds, tMax) != FLT_MAX)
+	{
+		stack[stackPointer++] = 0;
+	}
+
+	// Order doesn't matter for an any-hit query, so children aren't sorted //
+	while(stackPointer > 0 && !occluded)
+	{
+		const BVHNode& node = nodes[stack[--stackPointer]];
+		TRACE_STAT(stats.ShadowNodesVisited++);
+
+		if(node.IsLeaf())
+		{
+			occluded = OccludedSpheres(ray, node.LeftFirst, node.PrimitiveCount, tMax);
+
+			for(unsigned int i = node.LeftFirst; i < node.LeftFirst + node.PrimitiveCount && !occluded; i++)
+			{
+				if(primitiveSlots[i].Type == PrimitiveType::Sphere)
+				{
+					TRACE_STAT(stats.SphereTests++);
+				}
+				else
+				{
+					TRACE_STAT(CountPrimitiveTest(stats, primitiveSlots[i].Type));
+					float t = SlotDistance(i, ray, u, v);
+					occluded = t > EPSILON && t < tMax;
+				}
+			}
+
+			continue;
+		}
+
+		for(unsigned int child = node.LeftFirst; child < node.LeftFirst + 2; child++)
+		{
+			if(IntersectAABB(ray, invDirection, nodes[child].Bounds, tMax) != FLT_MAX)
+			{
+				stack[stackPointer++] = child;
+			}
+		}
+	}
+
+	TRACE_STAT(stats.OccludedShadowRays += occluded);
+	return occluded;
+}
+
+void BVH::Traverse(const Ray& ray, ClosestHit& hit, bool insideMedium)
+{
+	vec3 invDirection = vec3(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+
+	if(IntersectAABB(ray, invDirection, nodes[0].Bounds, hit.t) == FLT_MAX)
+	{
+		return;
+	}
+
+	unsigned int stack[stackSize];
+	unsigned int stackPointer = 0;
+	const BVHNode* node = &nodes[0];
+	TRACE_STAT(TraceStats& stats = TraceStats::Local());
+
+	while(true)
+	{
+		TRACE_STAT(stats.NodesVisited++);
+
+		if(node->IsLeaf())
+		{
+			IntersectSpheres(ray, node->LeftFirst, node->PrimitiveCount, hit, insideMedium);
+
+			// Spheres were already handled by the packet test above //
+			for(unsigned int i = node->LeftFirst; i < node->LeftFirst + node->PrimitiveCount; i++)
+			{
+				if(primitiveSlots[i].Type == PrimitiveType::Sphere)
+				{
+					TRACE_STAT(stats.SphereTests++);
+				}
+				else
+				{
+					TRACE_STAT(CountPrimitiveTest(stats, primitiveSlots[i].Type));
+					IntersectSlot(i, ray, hit, insideMedium);
+				}
+			}
+
+			if(stackPointer == 0)
+			{
+				break;
+			}
+
+			node = &nodes[stack[--stackPointer]];
+			continue;
+		}
+
+		// Visit the nearest child first, so the far child can often be culled //
+		unsigned int nearIndex = node->LeftFirst;
+		unsigned int farIndex = node->LeftFirst + 1;
+		float nearDistance = IntersectAABB(ray, invDirection, nodes[nearIndex].Bounds, hit.t);
+		float farDistance = IntersectAABB(ray, invDirection, nodes[farIndex].Bounds, hit.t);
+
+		if(nearDistance > farDistance)
+		{
+			std::swap(nearDistance, farDistance);
+			std::swap(nearIndex, farIndex);
+		}
+
+		if(nearDistance == FLT_MAX)
+		{
+			if(stackPointer == 0)
+			{
+				break;
+			}
+
+			node = &nodes[stack[--stackPointer]];
+			continue;
+		}
+
+		node = &nodes[nearIndex];
+		if(farDistance != FLT_MAX)
+		{
+			stack[stackPointer++] = farIndex;
+		}
+	}
+}
+
+void BVH::UpdateNodeBounds(unsigned int nodeIndex)
+{
+	BVHNode& node = nodes[nodeIndex];
+	node.Bounds = AABB();
+
+	for(unsigned int i = 0; i < node.PrimitiveCount; i++)
+	{
+		node.Bounds.Grow(primitiveBounds[primitiveIndices[node.LeftFirst + i]]);
+	}
+}
+
+void BVH::Subdivide(unsigned int nodeIndex, unsigned int depth)
+{
+	BVHNode& node = nodes[nodeIndex];
+
+	if(node.PrimitiveCount <= 2 || depth >= maxDepth)
+	{
+		return;
+	}
+
+	int axis;
+	float splitPosition;
+	float splitCost = FindBestSplit(node, axis, splitPosition);
+
+	// Only split if it is cheaper than intersecting everything inside of this node //
+	// Spheres inside of a leaf get tested a whole packet at a time.
+	unsigned int sphereCount = 0;
+	for(unsigned int i = 0; i < node.PrimitiveCount; i++)
+	{
+		if(primitives[primitiveIndices[node.LeftFirst + i]]->Type == PrimitiveType::Sphere)
+		{
+			sphereCount++;
+		}
+	}
+
+	unsigned int spherePackets = (sphereCount + sphereLanes - 1) / sphereLanes;
+	float leafCost = (spherePackets + node.PrimitiveCount - sphereCount) * node.Bounds.HalfArea();
+	if(splitCost >= leafCost)
+	{
+		return;
+	}
+
+	// Partition the primitive indices in-place around the split plane //
+	int i = node.LeftFirst;
+	int j = i + node.PrimitiveCount - 1;
+
+	while(i <= j)
+	{
+		if(primitiveCentroids[primitiveIndices[i]].data[axis] < splitPosition)
+		{
+			i++;
+		}
+		else
+		{
+			std::swap(primitiveIndices[i], primitiveIndices[j--]);
+		}
+	}
+
+	unsigned int leftCount = i - node.LeftFirst;
+	if(leftCount == 0 || leftCount == node.PrimitiveCount)
+	{
+		return;
+	}
+
+	unsigned int leftIndex = nodesUsed++;
+	unsigned int rightIndex = nodesUsed++;
+
+	nodes[leftIndex].LeftFirst = node.LeftFirst;
+	nodes[leftIndex].PrimitiveCount = leftCount;
+	nodes[rightIndex].LeftFirst = i;
+	nodes[rightIndex].PrimitiveCount = node.PrimitiveCount - leftCount;
+
+	node.LeftFirst = leftIndex;
+	node.PrimitiveCount = 0;
+
+	UpdateNodeBounds(leftIndex);
+	UpdateNodeBounds(rightIndex);
+
+	Subdivide(leftIndex, depth + 1);
+	Subdivide(rightIndex, depth + 1);
+}
+
+float BVH::FindBestSplit(const BVHNode& node, int& axis, float& splitPosition)
+{
+	struct Bin
+	{
+		AABB Bounds;
+		int SphereCount = 0;
+		int PrimitiveCount = 0;
+	};
+
+	// Same units as the leaf cost in 'Subdivide', spheres get tested a whole packet at a time //
+	auto intersectionCost = [](int sphereCount, int primitiveCount)
+	{
+		return float((sphereCount + sphereLanes - 1) / sphereLanes + primitiveCount - sphereCount);
+	};
+
+	float bestCost = FLT_MAX;
+
+	for(int a = 0; a < 3; a++)
+	{
+		// Bins are spread over the centroid bounds, not the node bounds //
+		float boundsMin = FLT_MAX;
+		float boundsMax = -FLT_MAX;
+
+		for(unsigned int i = 0; i < node.PrimitiveCount; i++)
+		{
+			const vec3& centroid = primitiveCentroids[primitiveIndices[node.LeftFirst + i]];
+			boundsMin = fminf(boundsMin, centroid.data[a]);
+			boundsMax = fmaxf(boundsMax, centroid.data[a]);
+		}
+
+		if(boundsMin == boundsMax)
+		{
+			continue;
+		}
+
+		Bin bins[binCount];
+		float scale = binCount / (boundsMax - boundsMin);
+
+		for(unsigned int i = 0; i < node.PrimitiveCount; i++)
+		{
+			unsigned int primitiveIndex = primitiveIndices[node.LeftFirst + i];
+			int binIndex = int((primitiveCentroids[primitiveIndex].data[a] - boundsMin) * scale);
+			binIndex = binIndex < binCount - 1 ? binIndex : binCount - 1;
+
+			bins[binIndex].PrimitiveCount++;
+			bins[binIndex].SphereCount += primitives[primitiveIndex]->Type == PrimitiveType::Sphere;
+			bins[binIndex].Bounds.Grow(primitiveBounds[primitiveIndex]);
+		}
+
+		// Sweep from both sides to gather the area & count left and right of every plane //
+		float leftArea[binCount - 1];
+		float rightArea[binCount - 1];
+		float leftCost[binCount - 1];
+		float rightCost[binCount - 1];
+
+		AABB leftBox;
+		AABB rightBox;
+		int leftSpheres = 0, leftSum = 0;
+		int rightSpheres = 0, rightSum = 0;
+
+		for(int i = 0; i < binCount - 1; i++)
+		{
+			leftSpheres += bins[i].SphereCount;
+			leftSum += bins[i].PrimitiveCount;
+			leftCost[i] = intersectionCost(leftSpheres, leftSum);
+			leftBox.Grow(bins[i].Bounds);
+			leftArea[i] = leftBox.IsValid() ? leftBox.HalfArea() : 0.0f;
+
+			rightSpheres += bins[binCount - 1 - i].SphereCount;
+			rightSum += bins[binCount - 1 - i].PrimitiveCount;
+			rightCost[binCount - 2 - i] = intersectionCost(rightSpheres, rightSum);
+			rightBox.Grow(bins[binCount - 1 - i].Bounds);
+			rightArea[binCount - 2 - i] = rightBox.IsValid() ? rightBox.HalfArea() : 0.0f;
+		}
+
+		float binWidth = (boundsMax - boundsMin) / binCount;
+		for(int i = 0; i < binCount - 1; i++)
+		{
+			float cost = leftCost[i] * leftArea[i] + rightCost[i] * rightArea[i];
+
+			if(cost < bestCost)
+			{
+				bestCost = cost;
+				axis = a;
+				splitPosition = boundsMin + binWidth * (i + 1);
+			}
+		}
+	}
+
+	return bestCost;
+}
+
+void BVH::BuildPrimitiveData()
+{
+	primitiveSlots.resize(primitiveIndices.size() + unboundedPrimitives.size());
+	slotPrimitives.resize(primitiveIndices.size() + unboundedPrimitives.size());
+	planes.clear();
+	triangles.clear();
+	infinitePlanes.clear();
+
+	// Padded by a packet, so the last leaf can always load a full packet //
+	unsigned int slotCount = primitiveIndices.size() + sphereLanes;
+	sphereX.assign(slotCount, 0.0f);
+	sphereY.assign(slotCount, 0.0f);
+	sphereZ.assign(slotCount, 0.0f);
+	sphereRadius2.assign(slotCount, -1.0f);
+
+	for(unsigned int i = 0; i < primitiveIndices.size(); i++)
+	{
+		Primitive* primitive = primitives[primitiveIndices[i]];
+		PrimitiveSlot& slot = primitiveSlots[i];
+
+		slot.Type = primitive->Type;
+		slotPrimitives[i] = primitive;
+
+		switch(primitive->Type)
+		{
+		case PrimitiveType::Sphere:
+		{
+			Sphere* sphere = static_cast<Sphere*>(primitive);
+			slot.Index = i;
+			sphereX[i] = sphere->Position.x;
+			sphereY[i] = sphere->Position.y;
+			sphereZ[i] = sphere->Position.z;
+			sphereRadius2[i] = sphere->Radius2;
+			break;
+		}
+		case PrimitiveType::Plane:
+			slot.Index = planes.size();
+			planes.push_back(static_cast<Plane*>(primitive)->GetData());
+			break;
+		case PrimitiveType::Triangle:
+			slot.Index = triangles.size();
+			triangles.push_back(static_cast<Triangle*>(primitive)->GetData());
+			break;
+		default:
+			break;
+		}
+	}
+
+	for(unsigned int i = 0; i < unboundedPrimitives.size(); i++)
+	{
+		unsigned int slot = primitiveIndices.size() + i;
+		primitiveSlots[slot].Type = PrimitiveType::PlaneInfinite;
+		primitiveSlots[slot].Index = infinitePlanes.size();
+		slotPrimitives[slot] = unboundedPrimitives[i];
+
+		infinitePlanes.push_back(static_cast<PlaneInfinite*>(unboundedPrimitives[i])->GetData());
+	}
+}
+
+/// <summary>
+/// Intersects the spheres in slots [first, first + count) a packet at a time.
+/// </summary>
+void BVH::IntersectSpheres(const Ray& ray, unsigned int first, unsigned int count, ClosestHit& hit, bool insideMedium)
+{
+	const RayLanes rayLanes = BroadcastRay(ray);
+	const Lanes epsilon = Set1(EPSILON);
+	const Lanes laneOffsets = LaneOffsets();
+
+	Lanes closestT = Set1(hit.t);
+	Lanes closestSlot = Set1(-1.0f);
+	Lanes closestInside = Set1(0.0f);
+
+	for(unsigned int i = 0; i < count; i += sphereLanes)
+	{
+		unsigned int slot = first + i;
+
+		Lanes valid;
+		Lanes inside;
+		Lanes t = SphereDistances(rayLanes, &sphereX[slot], &sphereY[slot], &sphereZ[slot], &sphereRadius2[slot], insideMedium, valid, inside);
+
+		// Lanes past the end of this leaf belong to the next one //
+		valid = And(valid, Less(laneOffsets, Set1(float(count - i))));
+
+		Lanes closer = And(valid, And(Less(epsilon, t), Less(t, closestT)));
+		closestT = Select(closer, t, closestT);
+		closestSlot = Select(closer, Add(Set1(float(slot)), laneOffsets), closestSlot);
+		closestInside = Select(closer, inside, closestInside);
+	}
+
+	float t[8];
+	float closestSlots[8];
+	float insides[8];
+	Store(t, closestT);
+	Store(closestSlots, closestSlot);
+	Store(insides, closestInside);
+
+	int closestLane = -1;
+	for(int lane = 0; lane < sphereLanes; lane++)
+	{
+		if(closestSlots[lane] >= 0.0f && (closestLane == -1 || t[lane] < t[closestLane]))
+		{
+			closestLane = lane;
+		}
+	}
+
+	if(closestLane == -1)
+	{
+		return;
+	}
+
+	hit.t = t[closestLane];
+	hit.Slot = (unsigned int)closestSlots[closestLane];
+	hit.InsideMedium = insides[closestLane] != 0.0f;
+}
+
+bool BVH::OccludedSpheres(const Ray& ray, unsigned int first, unsigned int count, float tMax)
+{
+	const RayLanes rayLanes = BroadcastRay(ray);
+	const Lanes epsilon = Set1(EPSILON);
+	const Lanes maxT = Set1(tMax);
+	const Lanes laneOffsets = LaneOffsets();
+
+	for(unsigned int i = 0; i < count; i += sphereLanes)
+	{
+		unsigned int slot = first + i;
+
+		Lanes valid;
+		Lanes inside;
+		Lanes t = SphereDistances(rayLanes, &sphereX[slot], &sphereY[slot], &sphereZ[slot], &sphereRadius2[slot], false, valid, inside);
+
+		valid = And(valid, Less(laneOffsets, Set1(float(count - i))));
+
+		if(Any(And(valid, And(Less(epsilon, t), Less(t, maxT)))))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Distance to the (non-sphere) primitive in 'slot', or -1 on a miss //
+float BVH::SlotDistance(unsigned int slot, const Ray& ray, float& u, float& v)
+{
+	const PrimitiveSlot& primitiveSlot = primitiveSlots[slot];
+
+	switch(primitiveSlot.Type)
+	{
+	case PrimitiveType::Plane:
+		return IntersectPlane(planes[primitiveSlot.Index], ray);
+	case PrimitiveType::Triangle:
+		return IntersectTriangle(triangles[primitiveSlot.Index], ray, u, v);
+	case PrimitiveType::PlaneInfinite:
+		return IntersectPlaneInfinite(infinitePlanes[primitiveSlot.Index], ray);
+	default:
+		return -1.0f;
+	}
+}
+
+void BVH::IntersectSlot(unsigned int slot, const Ray& ray, ClosestHit& hit, bool insideMedium)
+{
+	float u = 0.0f;
+	float v = 0.0f;
+	float t = SlotDistance(slot, ray, u, v);
+
+	if(t > EPSILON && t < hit.t)
+	{
+		hit.t = t;
+		hit.Slot = slot;
+		hit.U = u;
+		hit.V = v;
+		hit.InsideMedium = insideMedium;
+	}
+}
+
+/// <summary>
+/// Fills in the surface information of the closest hit, this is the only
+/// point where the hit point, normal and Primitive handle get computed.
+/// </summary>
+void BVH::ReconstructSurface(const Ray& ray, const ClosestHit& hit, HitRecord& record)
+{
+	const PrimitiveSlot& primitiveSlot = primitiveSlots[hit.Slot];
+
+	record.t = hit.t;
+	record.HitPoint = ray.At(hit.t);
+	record.Primitive = slotPrimitives[hit.Slot];
+	record.InsideMedium = hit.InsideMedium;
+	record.U = 0.0f;
+	record.V = 0.0f;
+
+	switch(primitiveSlot.Type)
+	{
+	case PrimitiveType::Sphere:
+	{
+		vec3 center = vec3(sphereX[hit.Slot], sphereY[hit.Slot], sphereZ[hit.Slot]);
+		record.Normal = Normalize(record.HitPoint - center);
+		break;
+	}
+	case PrimitiveType::Plane:
+		record.Normal = planes[primitiveSlot.Index].Normal;
+		break;
+	case PrimitiveType::Triangle:
+		record.Normal = triangles[primitiveSlot.Index].Normal;
+		record.U = hit.U;
+		record.V = hit.V;
+		break;
+	case PrimitiveType::PlaneInfinite:
+		record.Normal = infinitePlanes[primitiveSlot.Index].Normal;
+		break;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+
+#include "Math/AABB.h"
+#include "Primitive.h"
+#include "Plane.h"
+#include "PlaneInfinite.h"
+#include "Triangle.h"
+
+struct BVHNode
+{
+	AABB Bounds;
+
+	// Interior nodes: index of the left child, right child is always 'LeftFirst + 1'
+	// Leaf nodes: index of the first primitive inside 'primitiveIndices'
+	unsigned int LeftFirst;
+	unsigned int PrimitiveCount;
+
+	bool IsLeaf() const { return PrimitiveCount > 0; }
+};
+
+// Refers to an element of the per-type array matching 'Type' //
+struct PrimitiveSlot
+{
+	PrimitiveType Type;
+	unsigned int Index;
+};
+
+// All that traversal keeps track of, the rest of
+// the HitRecord gets reconstructed from it afterwards.
+struct ClosestHit
+{
+	float t;
+	unsigned int Slot;
+	float U, V;
+	bool InsideMedium;
+};
+
+/// <summary>
+/// Bounding Volume Hierarchy over the primitives of a scene, built using a binned
+/// surface area heuristic (SAH). Unbounded primitives such as infinite planes are
+/// kept outside of the tree and are always tested against.
+/// 
+/// Traversal never touches the Primitive objects themselves, every type gets copied
+/// into its own contiguous array and leaves dispatch on the type of each slot.
+/// The Primitive pointers only get looked up once a hit has been found.
+/// </summary>
+class BVH
+{
+public:
+	void Build(const std::vector<Primitive*>& scenePrimitives);
+	void Intersect(const Ray& ray, HitRecord& record);
+	bool Occluded(const Ray& ray, float tMax);
+
+private:
+	void Traverse(const Ray& ray, ClosestHit& hit, bool insideMedium);
+
+	void UpdateNodeBounds(unsigned int nodeIndex);
+	void Subdivide(unsigned int nodeIndex, unsigned int depth);
+	float FindBestSplit(const BVHNode& node, int& axis, float& splitPosition);
+
+	void BuildPrimitiveData();
+	void IntersectSpheres(const Ray& ray, unsigned int first, unsigned int count, ClosestHit& hit, bool insideMedium);
+	bool OccludedSpheres(const Ray& ray, unsigned int first, unsigned int count, float tMax);
+	float SlotDistance(unsigned int slot, const Ray& ray, float& u, float& v);
+	void IntersectSlot(unsigned int slot, const Ray& ray, ClosestHit& hit, bool insideMedium);
+	void ReconstructSurface(const Ray& ray, const ClosestHit& hit, HitRecord& record);
+
+private:
+	std::vector<Primitive*> primitives;
+	std::vector<Primitive*> unboundedPrimitives;
+
+	std::vector<unsigned int> primitiveIndices;
+	std::vector<AABB> primitiveBounds;
+	std::vector<vec3> primitiveCentroids;
+
+	std::vector<BVHNode> nodes;
+	unsigned int nodesUsed = 0;
+
+	// Primitive data in leaf order, 'slotPrimitives' maps a slot back to its handle.
+	// The unbounded primitives occupy the slots after the ones of the tree.
+	std::vector<PrimitiveSlot> primitiveSlots;
+	std::vector<Primitive*> slotPrimitives;
+	std::vector<PlaneData> planes;
+	std::vector<TriangleData> triangles;
+	std::vector<PlaneInfiniteData> infinitePlanes;
+
+	// Spheres stored as a structure of arrays, in the same order as 'primitiveIndices'.
+	// This way the spheres of a leaf are contiguous, and can be tested a packet at a time.
+	// Slots that hold any other primitive get a negative radius, so they always miss.
+	std::vector<float> sphereX;
+	std::vector<float> sphereY;
+	std::vector<float> sphereZ;
+	std::vector<float> sphereRadius2;
+
+	static const int binCount = 16;
+
+	// Traversal keeps its stack on the stack, a path from the root pushes at most one node per level,
+	// so past 'maxDepth' nodes always become leaves, however degenerate the scene is.
+	static const int stackSize = 64;
+	static const int maxDepth = stackSize - 1;
+	static const int sphereLanes;
+};
@@ -1,6 +1,9 @@
 #include "Camera.h"
 #include "Utilities/Utilities.h"
+
+#if !ACADEMIA_HEADLESS
 #include "Framework/Input.h"
+#endif
 
 Camera::Camera(unsigned int screenWidth, unsigned int screenHeight)
 {
@@ -20,6 +23,10 @@ Camera::Camera(vec3 position, unsigned int screenWidth, unsigned int screenHeigh
 
 bool Camera::Update(float deltaTime)
 {
+#if ACADEMIA_HEADLESS
+	// Without a window there is no input to move with //
+	return false;
+#else
 	bool cameraUpdated = false;
 	float speed = Speed * deltaTime;
 
@@ -62,6 +69,7 @@ bool Camera::Update(float deltaTime)
 	}
 
 	return cameraUpdated;
+#endif
 }
 
 void Camera::SetupVirtualPlane(unsigned int screenWidth, unsigned int screenHeight)
@@ -85,7 +93,8 @@ void Camera::SetupVirtualPlane(unsigned int screenWidth, unsigned int screenHeig
 	pixelSizeY = (1.0f / float(screenHeight)) * 0.5f;
 }
 
-Ray Camera::GetRay(int pixelX, int pixelY)
+// 'jitterX' & 'jitterY' are in [0, 1), where 0.5 lands on the middle of the pixel //
+Ray Camera::GetRay(int pixelX, int pixelY, float jitterX, float jitterY)
 {
 	// determine where on the virtual screen we need to be //
 	// Note: position is treated as the top-left corner of a pixel 
@@ -93,8 +102,8 @@ Ray Camera::GetRay(int pixelX, int pixelY)
 	float posY = pixelY / float(screenHeight);
 
 	// Anti-Aliasing (Monte-Carlo)
-	posX += RandomInRange(-pixelSizeX, pixelSizeX);
-	posY += RandomInRange(-pixelSizeY, pixelSizeY);
+	posX += (jitterX * 2.0f - 1.0f) * pixelSizeX;
+	posY += (jitterY * 2.0f - 1.0f) * pixelSizeY;
 
 	vec3 screenPoint = screenP0 + (screenU * posX) + (screenV * posY);
 	vec3 rayDirection = Normalize(screenPoint - Position);
@@ -10,7 +10,7 @@ public:
 	bool Update(float deltaTime);
 	void SetupVirtualPlane(unsigned int screenWidth, unsigned int screenHeight);
 
-	Ray GetRay(int pixelX, int pixelY);
+	Ray GetRay(int pixelX, int pixelY, float jitterX, float jitterY);
 
 public:
 	// Orientation //
@@ -3,6 +3,8 @@
 
 Plane::Plane(vec3 v0, vec3 v1, vec3 v2) : v0(v0)
 {
+	Type = PrimitiveType::Plane;
+
 	u = v1 - v0;
 	v = v2 - v0;
 
@@ -15,44 +17,25 @@ Plane::Plane(vec3 v0, vec3 v1, vec3 v2) : v0(v0)
 	v = Normalize(v);
 }
 
-void Plane::Intersect(const Ray& ray, HitRecord& record)
+AABB Plane::GetBounds()
 {
-	float denom = Dot(Normal, ray.Direction);
-
-	if(abs(denom) > 1e-6)
-	{
-		vec3 pToIntersect = Position - ray.Origin;
-		float d = Dot(pToIntersect, Normal);
-		float t = d / denom;
-
-		if(t >= 0.0f)
-		{
-			vec3 i = ray.At(t);
-			vec3 v0ToI = i - v0;
-
-			float dU = Dot(v0ToI, u);
-			if(dU < 0.0f || dU > w)
-			{
-				record.t = -1.0f;
-				return;
-			}
-
-			float dV = Dot(v0ToI, v);
-			if(dV < 0.0f || dV > h)
-			{
-				record.t = -1.0f;
-				return;
-			}
-
-			// We are inside of the boundaries of the plane
-			record.t = t;
-			record.HitPoint = i;
-			record.Normal = Normal;
-			record.Primitive = this;
-			return;
-		}
-	}
+	AABB bounds;
+	bounds.Grow(v0);
+	bounds.Grow(v0 + u * w);
+	bounds.Grow(v0 + v * h);
+	bounds.Grow(v0 + u * w + v * h);
+	return bounds;
+}
 
-	record.t = -1.0f;
-	return;
-}
\ No newline at end of file
+PlaneData Plane::GetData() const
+{
+	PlaneData data;
+	data.Position = Position;
+	data.Normal = Normal;
+	data.v0 = v0;
+	data.u = u;
+	data.v = v;
+	data.w = w;
+	data.h = h;
+	return data;
+}
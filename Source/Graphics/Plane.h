@@ -1,16 +1,63 @@
 #pragma once
 #include "Primitive.h"
 
+/// <summary>
+/// Everything needed to intersect a Plane, stored contiguously by the BVH.
+/// </summary>
+struct PlaneData
+{
+	vec3 Position;
+	vec3 Normal;
+	vec3 v0, u, v;
+	float w, h;
+};
+
 class Plane : public Primitive
 {
 public:
 	Plane(vec3 v0, vec3 v1, vec3 v2);
 
+	virtual AABB GetBounds() override;
+	PlaneData GetData() const;
+
 	vec3 Normal;
 
 private:
-	virtual void Intersect(const Ray& ray, HitRecord& record) override;
-
 	vec3 u, v, v0;
 	float w, h;
-};
\ No newline at end of file
+};
+
+// Returns the distance along the ray, or -1 on a miss //
+inline float IntersectPlane(const PlaneData& plane, const Ray& ray)
+{
+	float denom = Dot(plane.Normal, ray.Direction);
+
+	if(fabsf(denom) > 1e-6f)
+	{
+		vec3 pToIntersect = plane.Position - ray.Origin;
+		float d = Dot(pToIntersect, plane.Normal);
+		float t = d / denom;
+
+		if(t >= 0.0f)
+		{
+			vec3 v0ToI = ray.At(t) - plane.v0;
+
+			float dU = Dot(v0ToI, plane.u);
+			if(dU < 0.0f || dU > plane.w)
+			{
+				return -1.0f;
+			}
+
+			float dV = Dot(v0ToI, plane.v);
+			if(dV < 0.0f || dV > plane.h)
+			{
+				return -1.0f;
+			}
+
+			// We are inside of the boundaries of the plane
+			return t;
+		}
+	}
+
+	return -1.0f;
+}
@@ -9,26 +9,17 @@ PlaneInfinite::PlaneInfinite(vec3 position, vec3 normal)
 	Normal = normal;
 }
 
-void PlaneInfinite::Intersect(const Ray& ray, HitRecord& record)
+// Infinite planes have no meaningful bounds, which is why
+// the BVH keeps them outside of the tree.
+AABB PlaneInfinite::GetBounds()
 {
-	float denom = Dot(Normal, ray.Direction);
-
-	if (abs(denom) > 1e-6)
-	{
-		vec3 pToIntersect = Position - ray.Origin;
-		float d = Dot(pToIntersect, Normal);
-		float t = d / denom;
-
-		if (t >= 0.0f)
-		{
-			record.t = t;
-			record.HitPoint = ray.At(t);
-			record.Normal = Normal;
-			record.Primitive = this;
-			return;
-		}
-	}
+	return AABB(vec3(-FLT_MAX), vec3(FLT_MAX));
+}
 
-	record.t = -1.0f;
-	return;
-}
\ No newline at end of file
+PlaneInfiniteData PlaneInfinite::GetData() const
+{
+	PlaneInfiniteData data;
+	data.Position = Position;
+	data.Normal = Normal;
+	return data;
+}
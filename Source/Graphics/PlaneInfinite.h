@@ -1,13 +1,42 @@
 #pragma once
 #include "Primitive.h"
 
+/// <summary>
+/// Everything needed to intersect a PlaneInfinite, stored contiguously by the BVH.
+/// </summary>
+struct PlaneInfiniteData
+{
+	vec3 Position;
+	vec3 Normal;
+};
+
 class PlaneInfinite : public Primitive
 {
 public:
 	PlaneInfinite(vec3 position, vec3 normal);
 
-	virtual void Intersect(const Ray& ray, HitRecord& record) override;
+	virtual AABB GetBounds() override;
+	PlaneInfiniteData GetData() const;
 
 	vec3 Normal;
 };
 
+// Returns the distance along the ray, or -1 on a miss //
+inline float IntersectPlaneInfinite(const PlaneInfiniteData& plane, const Ray& ray)
+{
+	float denom = Dot(plane.Normal, ray.Direction);
+
+	if(fabsf(denom) > 1e-6f)
+	{
+		vec3 pToIntersect = plane.Position - ray.Origin;
+		float d = Dot(pToIntersect, plane.Normal);
+		float t = d / denom;
+
+		if(t >= 0.0f)
+		{
+			return t;
+		}
+	}
+
+	return -1.0f;
+}
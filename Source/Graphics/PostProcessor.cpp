@@ -1,67 +1,109 @@
 #include "PostProcessor.h"
 #include <cmath>
+#include <vector>
+#include <algorithm>
 #include "Utilities/Utilities.h"
+#include "Utilities/Profiler.h"
 #include "Math/MathCommon.h"
+#include "Framework/WorkerSystem.h"
 
-PostProcessor::PostProcessor(unsigned int screenWidth, unsigned int screenHeight) :
-	screenWidth(screenWidth), screenHeight(screenHeight)
+// Amount of rows handed out to a worker at once //
+static const unsigned int RowsPerJob = 16;
+
+// Amount of pixels the heatmap its scale gets estimated from //
+static const unsigned int HeatmapPercentileSamples = 65536;
+
+// Keeps black surfaces from dividing by zero when the albedo gets divided out //
+static const float DemodulationEpsilon = 0.001f;
+
+// Schraudolph 1999, "A Fast, Compact Approximation of the Exponential Function".
+// Writes 'x / ln(2)' straight into the exponent bits of a float, within a few percent of 'expf',
+// which is plenty for the denoiser its edge-stopping weights, at a fraction of the cost.
+static inline float FastExp(float x)
+{
+	x = max(x, -80.0f);
+
+	union { float f; int i; } bits;
+	bits.i = int(12102203.0f * x + 1064866805.0f);
+	return bits.f;
+}
+
+PostProcessor::PostProcessor(WorkerSystem* workerSystem, unsigned int screenWidth, unsigned int screenHeight) :
+	workerSystem(workerSystem), screenWidth(screenWidth), screenHeight(screenHeight)
 {
 	postProcessBuffer = new vec3[screenWidth * screenHeight];
 	postProcessBackBuffer = new vec3[screenWidth * screenHeight];
-	processedBuffer = new unsigned int[screenWidth * screenHeight];
-
-	gammaInverse = 1.0f / gamma;
 
+	SetGamma(gamma);
 	GenerateGaussianFilter();
 }
 
-void PostProcessor::PostProcess(vec3* sampleBuffer, int sampleCount)
+PostProcessor::~PostProcessor()
 {
-	float sampleINV = (1.0f / (float)sampleCount);
-	for(int x = 0; x < screenWidth; x++)
-	{
-		for(int y = 0; y < screenHeight; y++)
-		{
-			int i = x + y * screenWidth;
-			vec3 color = sampleBuffer[i] * sampleINV; // average out all samples taken
+	delete[] postProcessBuffer;
+	delete[] postProcessBackBuffer;
+}
 
-			if(exposure != 1.0f)
-			{
-				color = color * exposure;
-			}
+void PostProcessor::PostProcess(const vec3* sampleBuffer, const SurfaceFeatures* featureBuffer, int sampleCount, unsigned int* destination)
+{
+	PROFILE_ZONE("Post Process");
 
-			if(doACESTonemapping)
-			{
-				float a = 2.51f;
-				float b = 0.03f;
-				float c = 2.43f;
-				float d = 0.59f;
-				float e = 0.14f;
-				color.x = (color.x * (a * color.x + b)) / (color.x * (c * color.x + d) + e);
-				color.y = (color.y * (a * color.y + b)) / (color.y * (c * color.y + d) + e);
-				color.z = (color.z * (a * color.z + b)) / (color.z * (c * color.z + d) + e);
-			}
+	// Costs only need averaging & coloring, filtering would smear out the expensive pixels //
+	if(showHeatmap)
+	{
+		PostProcessHeatmap(sampleBuffer, sampleCount, destination);
+		return;
+	}
 
-			color.x = pow(Clamp(color.x, 0.0f, 1.0f), gammaInverse);
-			color.y = pow(Clamp(color.y, 0.0f, 1.0f), gammaInverse);
-			color.z = pow(Clamp(color.z, 0.0f, 1.0f), gammaInverse);
+	float scale = exposure / (float)sampleCount; // average out all samples taken
 
-			postProcessBuffer[i] = color;
-		}
+	// The denoiser averages the samples itself, its output only needs exposure //
+	if(doDenoising)
+	{
+		sampleBuffer = Denoise(sampleBuffer, featureBuffer, 1.0f / (float)sampleCount);
+		scale = exposure;
 	}
 
+	// Exposure, tonemapping, gamma & packing all happen in one pass over the image,
+	// unless the filter needs the neighbouring pixels, then its last pass does the packing.
+	ForEachRowBand([&](unsigned int yStart, unsigned int yEnd)
+	{
+		ToneMapRows(sampleBuffer, scale, destination, yStart, yEnd);
+	});
+
 	if(doGaussianFilter)
 	{
-		ApplyGaussianFilter(screenWidth, screenHeight);
+		ForEachRowBand([&](unsigned int yStart, unsigned int yEnd) { GaussianFilterHorizontal(yStart, yEnd); });
+		ForEachRowBand([&](unsigned int yStart, unsigned int yEnd) { GaussianFilterVertical(destination, yStart, yEnd); });
 	}
 }
 
-void PostProcessor::CopyProcessedData(unsigned int* screenBuffer)
+void PostProcessor::PostProcessHeatmap(const vec3* sampleBuffer, int sampleCount, unsigned int* destination)
 {
-	for(int i = 0; i < screenWidth * screenHeight; i++)
+	// The scale runs up to the 99th percentile instead of the maximum, otherwise a single
+	// pixel that got preempted halfway through its path washes out the trace time of all others.
+	// Estimated from an evenly spread subset of the pixels, which is plenty for a color scale.
+	unsigned int pixelCount = screenWidth * screenHeight;
+	unsigned int stride = max(pixelCount / HeatmapPercentileSamples, 1u);
+
+	std::vector<float> costs;
+	costs.reserve(pixelCount / stride + 1);
+
+	for(unsigned int i = 0; i < pixelCount; i += stride)
 	{
-		screenBuffer[i] = AlbedoToRGB(postProcessBuffer[i].x, postProcessBuffer[i].y, postProcessBuffer[i].z);
+		costs.push_back(sampleBuffer[i].x);
 	}
+
+	auto percentile = costs.begin() + (costs.size() * 99) / 100;
+	std::nth_element(costs.begin(), percentile, costs.end());
+
+	heatmapMax = *percentile / (float)sampleCount;
+	float scale = *percentile > 0.0f ? 1.0f / *percentile : 0.0f;
+
+	ForEachRowBand([&](unsigned int yStart, unsigned int yEnd)
+	{
+		HeatmapRows(sampleBuffer, scale, destination, yStart, yEnd);
+	});
 }
 
 void PostProcessor::Resize(unsigned int screenWidth, unsigned int screenHeight)
@@ -69,65 +111,376 @@ void PostProcessor::Resize(unsigned int screenWidth, unsigned int screenHeight)
 	this->screenWidth = screenWidth;
 	this->screenHeight = screenHeight;
 
+	delete[] postProcessBuffer;
+	delete[] postProcessBackBuffer;
+
 	postProcessBuffer = new vec3[screenWidth * screenHeight];
 	postProcessBackBuffer = new vec3[screenWidth * screenHeight];
-	processedBuffer = new unsigned int[screenWidth * screenHeight];
 }
 
-void PostProcessor::ApplyGaussianFilter(int screenWidth, int screenHeight)
+void PostProcessor::SetGamma(float gamma)
+{
+	this->gamma = gamma;
+	gammaInverse = 1.0f / gamma;
+
+	BuildGammaTable();
+}
+
+/// <summary>
+/// Splits the image up in bands of 'RowsPerJob' rows, and hands those out to the workers.
+/// Returns once every band is done, so consecutive calls act as a barrier between passes.
+/// </summary>
+void PostProcessor::ForEachRowBand(const std::function<void(unsigned int, unsigned int)>& function)
 {
-	if(!doGaussianFilter)
+	unsigned int jobCount = (screenHeight + RowsPerJob - 1) / RowsPerJob;
+
+	workerSystem->ParallelFor(jobCount, [&](unsigned int job)
 	{
-		return;
+		unsigned int yStart = job * RowsPerJob;
+		function(yStart, min(yStart + RowsPerJob, screenHeight));
+	});
+}
+
+void PostProcessor::ToneMapRows(const vec3* source, float scale, unsigned int* destination, unsigned int yStart, unsigned int yEnd)
+{
+	unsigned int start = yStart * screenWidth;
+	unsigned int end = yEnd * screenWidth;
+
+	if(doGaussianFilter)
+	{
+		for(unsigned int i = start; i < end; i++)
+		{
+			postProcessBuffer[i] = GammaCorrect(ToneMap(source[i], scale));
+		}
+	}
+	else
+	{
+		for(unsigned int i = start; i < end; i++)
+		{
+			destination[i] = PackRGBA8(GammaCorrect(ToneMap(source[i], scale)));
+		}
+	}
+}
+
+void PostProcessor::HeatmapRows(const vec3* source, float scale, unsigned int* destination, unsigned int yStart, unsigned int yEnd)
+{
+	for(unsigned int i = yStart * screenWidth; i < yEnd * screenWidth; i++)
+	{
+		destination[i] = PackRGBA8(HeatmapColor(source[i].x * scale));
+	}
+}
+
+/// <summary>
+/// Edge-avoiding A-Trous wavelet transform, from Dammertz et al. 2010, "Edge-Avoiding A-Trous Wavelet Transform for fast Global Illumination Filtering".
+/// Every iteration applies the same 5x5 B3-spline kernel, with the taps spread twice as far apart as in the last one.
+/// Lighting gets filtered with the albedo divided out, so textures stay sharp, and gets multiplied back in at the end.
+/// Ping-pongs between the two post-process buffers, and returns whichever holds the result.
+/// </summary>
+const vec3* PostProcessor::Denoise(const vec3* sampleBuffer, const SurfaceFeatures* featureBuffer, float sampleINV)
+{
+	PROFILE_ZONE("Denoise");
+
+	vec3* source = postProcessBackBuffer;
+	vec3* destination = postProcessBuffer;
+
+	ForEachRowBand([&](unsigned int yStart, unsigned int yEnd)
+	{
+		DemodulateRows(sampleBuffer, featureBuffer, sampleINV, yStart, yEnd);
+	});
+
+	int iterations = max(denoiseIterations, 1);
+	for(int i = 0; i < iterations; i++)
+	{
+		// Detail that survived the earlier iterations is more likely to be real, so the color weight gets stricter //
+		float colorPhi = denoiseColorPhi / float(1 << i);
+		bool remodulate = i == iterations - 1;
+
+		ForEachRowBand([&](unsigned int yStart, unsigned int yEnd)
+		{
+			DenoiseRows(source, destination, featureBuffer, 1 << i, colorPhi, remodulate, yStart, yEnd);
+		});
+
+		vec3* temp = source;
+		source = destination;
+		destination = temp;
+	}
+
+	return source;
+}
+
+void PostProcessor::DemodulateRows(const vec3* sampleBuffer, const SurfaceFeatures* featureBuffer, float sampleINV, unsigned int yStart, unsigned int yEnd)
+{
+	for(unsigned int i = yStart * screenWidth; i < yEnd * screenWidth; i++)
+	{
+		vec3 albedo = featureBuffer[i].Albedo + vec3(DemodulationEpsilon);
+		vec3 color = sampleBuffer[i] * sampleINV;
+
+		postProcessBackBuffer[i] = vec3(color.x / albedo.x, color.y / albedo.y, color.z / albedo.z);
 	}
+}
 
-	for(int x = 0; x < screenWidth; x++)
+void PostProcessor::DenoiseRows(const vec3* source, vec3* destination, const SurfaceFeatures* featureBuffer, int stepSize, float colorPhi,
+	bool remodulate, unsigned int yStart, unsigned int yEnd)
+{
+	const float kernel[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+	int width = screenWidth;
+	int height = screenHeight;
+
+	// Normals get compared further apart every iteration, so their difference is scaled down with the step size //
+	float colorScale = 1.0f / colorPhi;
+	float normalScale = 1.0f / (denoiseNormalPhi * stepSize * stepSize);
+	float depthScale = 1.0f / denoiseDepthPhi;
+
+	for(int y = yStart; y < (int)yEnd; y++)
 	{
-		for(int y = 0; y < screenHeight; y++)
+		for(int x = 0; x < width; x++)
 		{
+			int i = x + y * width;
+			vec3 color = source[i];
+			const SurfaceFeatures& features = featureBuffer[i];
+			float depthINV = 1.0f / max(features.Depth, EPSILON);
+
 			vec3 sum;
+			float weightSum = 0.0f;
 
-			for(int i = -3; i <= 3; i++)
+			for(int ky = -2; ky <= 2; ky++)
 			{
-				for(int j = -3; j <= 3; j++)
+				int sy = y + ky * stepSize;
+				if(sy < 0 || sy >= height)
 				{
-					int xIndex = Clamp(x + i, 0, screenWidth - 1);
-					int yIndex = Clamp(y + j, 0, screenHeight - 1);
-					int index = xIndex + yIndex * screenWidth;
+					continue;
+				}
+
+				for(int kx = -2; kx <= 2; kx++)
+				{
+					int sx = x + kx * stepSize;
+					if(sx < 0 || sx >= width)
+					{
+						continue;
+					}
+
+					int j = sx + sy * width;
+					const SurfaceFeatures& neighbour = featureBuffer[j];
+
+					vec3 colorDifference = color - source[j];
+					vec3 normalDifference = features.Normal - neighbour.Normal;
+					float depthDifference = (features.Depth - neighbour.Depth) * depthINV;
 
-					sum += postProcessBuffer[index] * GaussianFilter[i + 3][j + 3];
+					float distance = Dot(colorDifference, colorDifference) * colorScale
+						+ Dot(normalDifference, normalDifference) * normalScale
+						+ depthDifference * depthDifference * depthScale;
+
+					float weight = FastExp(-distance) * kernel[kx + 2] * kernel[ky + 2];
+					sum += source[j] * weight;
+					weightSum += weight;
 				}
 			}
 
-			postProcessBackBuffer[x + y * screenWidth] = sum;
+			// The center tap has no difference to itself, so 'weightSum' never hits 0 //
+			vec3 filtered = sum * (1.0f / weightSum);
+
+			if(remodulate)
+			{
+				filtered = filtered * (features.Albedo + vec3(DemodulationEpsilon));
+			}
+
+			destination[i] = filtered;
 		}
 	}
-
-	memcpy(postProcessBuffer, postProcessBackBuffer, sizeof(vec3) * screenWidth * screenHeight);
 }
 
-void PostProcessor::GenerateGaussianFilter()
+void PostProcessor::GaussianFilterHorizontal(unsigned int yStart, unsigned int yEnd)
 {
-	float r, s = 2.0f * gaussianSigma * gaussianSigma;
-	float sum = 0.0f;
+	int width = screenWidth;
+	int radius = gaussianRadius;
+	const float* kernel = gaussianKernel + radius;
 
-	for(int x = -3; x <= 3; x++)
+	// Only pixels within 'radius' of the left & right edge need their taps clamped //
+	int interiorStart = min(radius, width);
+	int interiorEnd = max(width - radius, interiorStart);
+
+	for(unsigned int y = yStart; y < yEnd; y++)
 	{
-		for(int y = -3; y <= 3; y++)
+		const vec3* source = postProcessBuffer + y * width;
+		vec3* destination = postProcessBackBuffer + y * width;
+
+		for(int x = 0; x < interiorStart; x++)
+		{
+			vec3 sum;
+			for(int i = -radius; i <= radius; i++)
+			{
+				sum += source[Clamp(x + i, 0, width - 1)] * kernel[i];
+			}
+			destination[x] = sum;
+		}
+
+		for(int x = interiorStart; x < interiorEnd; x++)
+		{
+			vec3 sum;
+			for(int i = -radius; i <= radius; i++)
+			{
+				sum += source[x + i] * kernel[i];
+			}
+			destination[x] = sum;
+		}
+
+		for(int x = interiorEnd; x < width; x++)
 		{
-			r = sqrtf(x * x + y * y);
-			GaussianFilter[x + 3][y + 3] = (expf(-(r * r) / s)) / (PI * s);
-			sum += GaussianFilter[x + 3][y + 3];
+			vec3 sum;
+			for(int i = -radius; i <= radius; i++)
+			{
+				sum += source[Clamp(x + i, 0, width - 1)] * kernel[i];
+			}
+			destination[x] = sum;
 		}
 	}
+}
+
+void PostProcessor::GaussianFilterVertical(unsigned int* destination, unsigned int yStart, unsigned int yEnd)
+{
+	int width = screenWidth;
+	int height = screenHeight;
+	int radius = gaussianRadius;
 
-	float ss = 0.0f;
-	for(int i = 0; i < 7; i++)
+	// Every tap reads a whole row, so clamping at the top & bottom edge
+	// happens once per row, instead of once per tap in the inner loop.
+	const vec3* rows[2 * MaxGaussianRadius + 1];
+
+	for(int y = yStart; y < (int)yEnd; y++)
 	{
-		for(int j = 0; j < 7; j++)
+		for(int i = -radius; i <= radius; i++)
+		{
+			rows[i + radius] = postProcessBackBuffer + Clamp(y + i, 0, height - 1) * width;
+		}
+
+		unsigned int* row = destination + y * width;
+
+		for(int x = 0; x < width; x++)
 		{
-			GaussianFilter[i][j] /= sum;
-			ss += GaussianFilter[i][j];
+			vec3 sum;
+			for(int i = 0; i <= 2 * radius; i++)
+			{
+				sum += rows[i][x] * gaussianKernel[i];
+			}
+
+			// Already gamma corrected, so it only needs packing //
+			row[x] = PackRGBA8(sum);
 		}
 	}
 }
+
+void PostProcessor::GenerateGaussianFilter()
+{
+	gaussianRadius = Clamp(gaussianRadius, 1, MaxGaussianRadius);
+
+	float s = 2.0f * gaussianSigma * gaussianSigma;
+	float sum = 0.0f;
+
+	for(int i = -gaussianRadius; i <= gaussianRadius; i++)
+	{
+		gaussianKernel[i + gaussianRadius] = expf(-(float)(i * i) / s);
+		sum += gaussianKernel[i + gaussianRadius];
+	}
+
+	for(int i = 0; i <= 2 * gaussianRadius; i++)
+	{
+		gaussianKernel[i] /= sum;
+	}
+}
+
+void PostProcessor::BuildGammaTable()
+{
+	// Entry 'i' holds the gamma corrected value of (i / (size - 1))^2 //
+	for(int i = 0; i < GammaTableSize; i++)
+	{
+		float s = (float)i / (float)(GammaTableSize - 1);
+		gammaTable[i] = powf(s * s, gammaInverse);
+	}
+}
+
+/// <summary>
+/// Applies the averaging & exposure 'scale' and the ACES curve to all channels at once.
+/// The result gets clamped to [0-1], ready to be gamma corrected.
+/// </summary>
+inline vec3 PostProcessor::ToneMap(const vec3& sample, float scale) const
+{
+	vec3 color = sample * scale;
+
+	if(doACESTonemapping)
+	{
+		const float a = 2.51f;
+		const float b = 0.03f;
+		const float c = 2.43f;
+		const float d = 0.59f;
+		const float e = 0.14f;
+
+		vec3 numerator = color * (color * a + vec3(b));
+		vec3 denominator = color * (color * c + vec3(d)) + vec3(e);
+
+#if USE_SIMD_VEC3
+		color = vec3(_mm_div_ps(numerator.simd, denominator.simd));
+#else
+		color = vec3(numerator.x / denominator.x, numerator.y / denominator.y, numerator.z / denominator.z);
+#endif
+	}
+
+#if USE_SIMD_VEC3
+	// 'dummy' divides 0 by 0, but max returns its second operand for NaN, which keeps the alpha byte at 0 //
+	return vec3(_mm_min_ps(_mm_max_ps(color.simd, _mm_setzero_ps()), _mm_set_ps(0.0f, 1.0f, 1.0f, 1.0f)));
+#else
+	return vec3(Clamp(color.x, 0.0f, 1.0f), Clamp(color.y, 0.0f, 1.0f), Clamp(color.z, 0.0f, 1.0f));
+#endif
+}
+
+/// <summary>
+/// Looks up the gamma corrected value of every channel in the table.
+/// </summary>
+inline vec3 PostProcessor::GammaCorrect(const vec3& color) const
+{
+#if USE_SIMD_VEC3
+	// Only SSE2, every lane gets shuffled down into the lowest one to read it //
+	__m128i index = _mm_cvtps_epi32(_mm_mul_ps(_mm_sqrt_ps(color.simd), _mm_set1_ps(GammaTableSize - 1)));
+	return vec3(gammaTable[_mm_cvtsi128_si32(index)], gammaTable[_mm_cvtsi128_si32(_mm_shuffle_epi32(index, _MM_SHUFFLE(1, 1, 1, 1)))],
+		gammaTable[_mm_cvtsi128_si32(_mm_shuffle_epi32(index, _MM_SHUFFLE(2, 2, 2, 2)))]);
+#else
+	float r = gammaTable[int(sqrtf(color.x) * (GammaTableSize - 1) + 0.5f)];
+	float g = gammaTable[int(sqrtf(color.y) * (GammaTableSize - 1) + 0.5f)];
+	float b = gammaTable[int(sqrtf(color.z) * (GammaTableSize - 1) + 0.5f)];
+	return vec3(r, g, b);
+#endif
+}
+
+/// <summary>
+/// Packs a color in [0-1] as 8-bit RGBA with red in the lowest byte, the same layout as 'AlbedoToRGB'.
+/// </summary>
+inline unsigned int PostProcessor::PackRGBA8(const vec3& color) const
+{
+#if USE_SIMD_VEC3
+	// Truncated like 'AlbedoToRGB', then narrowed 32 -> 16 -> 8 bits per channel. Clamping first keeps
+	// every channel in range of the signed 32 -> 16 bit pack, SSE2 has no unsigned one //
+	__m128 scaled = _mm_min_ps(_mm_max_ps(_mm_mul_ps(color.simd, _mm_set1_ps(255.0f)), _mm_setzero_ps()), _mm_set1_ps(255.0f));
+	__m128i c = _mm_cvttps_epi32(scaled);
+	c = _mm_packs_epi32(c, c);
+	return _mm_cvtsi128_si32(_mm_packus_epi16(c, c));
+#else
+	return AlbedoToRGB(color.x, color.y, color.z);
+#endif
+}
+
+// Black -> blue -> cyan -> green -> yellow -> red -> white, for 't' in [0, 1] //
+inline vec3 PostProcessor::HeatmapColor(float t) const
+{
+	static const vec3 stops[] =
+	{
+		vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 1.0f, 1.0f), vec3(0.0f, 1.0f, 0.0f),
+		vec3(1.0f, 1.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(1.0f, 1.0f, 1.0f)
+	};
+	const int lastStop = sizeof(stops) / sizeof(stops[0]) - 1;
+
+	float position = Clamp(t, 0.0f, 1.0f) * lastStop;
+	int stop = min(int(position), lastStop - 1);
+	float blend = position - stop;
+
+	return stops[stop] * (1.0f - blend) + stops[stop + 1] * blend;
+}
@@ -1,24 +1,47 @@
 #pragma once
 #include "Math/Vec3.h"
+#include "SurfaceFeatures.h"
+#include <functional>
+
+class WorkerSystem;
 
 class PostProcessor
 {
 public:
-	PostProcessor(unsigned int screenWidth, unsigned int screenHeight);
+	PostProcessor(WorkerSystem* workerSystem, unsigned int screenWidth, unsigned int screenHeight);
+	~PostProcessor();
 
-	void PostProcess(vec3* sampleBuffer, int sampleCount);
-	void CopyProcessedData(unsigned int* screenBuffer);
+	// Writes the final 8-bit RGBA pixels into 'destination', which can be write-combined memory, it never gets read //
+	void PostProcess(const vec3* sampleBuffer, const SurfaceFeatures* featureBuffer, int sampleCount, unsigned int* destination);
 
 	void Resize(unsigned int screenWidth, unsigned int screenHeight);
+	void SetGamma(float gamma);
 
 private:
-	void ApplyGaussianFilter(int screenWidth, int screenHeight);
+	void PostProcessHeatmap(const vec3* sampleBuffer, int sampleCount, unsigned int* destination);
+	void ForEachRowBand(const std::function<void(unsigned int, unsigned int)>& function);
+	void ToneMapRows(const vec3* source, float scale, unsigned int* destination, unsigned int yStart, unsigned int yEnd);
+	void HeatmapRows(const vec3* source, float scale, unsigned int* destination, unsigned int yStart, unsigned int yEnd);
+
+	const vec3* Denoise(const vec3* sampleBuffer, const SurfaceFeatures* featureBuffer, float sampleINV);
+	void DemodulateRows(const vec3* sampleBuffer, const SurfaceFeatures* featureBuffer, float sampleINV, unsigned int yStart, unsigned int yEnd);
+	void DenoiseRows(const vec3* source, vec3* destination, const SurfaceFeatures* featureBuffer, int stepSize, float colorPhi,
+		bool remodulate, unsigned int yStart, unsigned int yEnd);
+	void GaussianFilterHorizontal(unsigned int yStart, unsigned int yEnd);
+	void GaussianFilterVertical(unsigned int* destination, unsigned int yStart, unsigned int yEnd);
 	void GenerateGaussianFilter();
+	void BuildGammaTable();
+
+	inline vec3 ToneMap(const vec3& sample, float scale) const;
+	inline vec3 GammaCorrect(const vec3& color) const;
+	inline vec3 HeatmapColor(float t) const;
+	inline unsigned int PackRGBA8(const vec3& color) const;
 
 private:
+	WorkerSystem* workerSystem;
+
 	vec3* postProcessBuffer;
 	vec3* postProcessBackBuffer;
-	unsigned int* processedBuffer;
 
 	unsigned int screenWidth, screenHeight;
 
@@ -29,8 +52,35 @@ private:
 	float gammaInverse = 1.0f;
 	float exposure = 0.545f;
 
-	float GaussianFilter[7][7];
+	// Denoising //
+	// Edge-avoiding A-Trous wavelet filter, runs on the averaged samples before tonemapping.
+	// The color, normal & depth weights decide how much a neighbour gets to contribute.
+	bool doDenoising = false;
+	int denoiseIterations = 4;
+	float denoiseColorPhi = 0.4f;
+	float denoiseNormalPhi = 0.1f;
+	float denoiseDepthPhi = 0.001f;
+
+	// Heatmap //
+	// Shows the samples as trace costs on a false-color scale, see 'HeatmapMode'.
+	// The scale runs up to 'heatmapMax', the average cost of the 99th percentile pixel.
+	bool showHeatmap = false;
+	float heatmapMax = 0.0f;
+
+	// Gamma Correction //
+	// Indexed by the square root of the linear value rather than the value itself,
+	// which spreads the entries out over the dark end where the pow curve is the steepest.
+	static const int GammaTableSize = 4096;
+	float gammaTable[GammaTableSize];
+
+	// Gaussian Filter //
+	// Separable, so it runs as a horizontal pass into 'postProcessBackBuffer',
+	// followed by a vertical pass that packs straight into the destination.
+	static const int MaxGaussianRadius = 16;
+	float gaussianKernel[2 * MaxGaussianRadius + 1];
+	int gaussianRadius = 3;
 	float gaussianSigma = 1.0f;
 
 	friend class Editor;
-};
\ No newline at end of file
+	friend class BatchRenderer;
+};
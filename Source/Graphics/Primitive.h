@@ -1,5 +1,6 @@
 #pragma once
 #include "Math/MathCommon.h"
+#include "Math/AABB.h"
 #include <string>
 
 class Ray;
@@ -31,6 +32,9 @@ struct Material
 	bool isEmissive = false;
 };
 
+// Lights are not part of the geometry, so they can only be reached through direct light sampling.
+// Without 'HasArea' a light is a point light, otherwise it's a rectangle of 'Scale.x' by 'Scale.z'
+// centered on 'Position' that emits downwards (-Y), like a ceiling light.
 struct Light
 {
 	vec3 Color = vec3(1.0f);
@@ -46,8 +50,12 @@ struct HitRecord
 	float t;
 	vec3 HitPoint;
 	vec3 Normal;
-	Primitive* Primitive = nullptr;
+	::Primitive* Primitive = nullptr;
 	bool InsideMedium = false;
+
+	// Barycentric coordinates of the hit, only filled in for triangles //
+	float U = 0.0f;
+	float V = 0.0f;
 };
 
 enum class PrimitiveType
@@ -58,14 +66,17 @@ enum class PrimitiveType
 	Triangle 
 };
 
+// Primitives are only a handle for the editor & scene, intersection is done by the BVH
+// on contiguous per-type copies (see 'PlaneData', 'TriangleData' etc.), dispatched on 'Type'.
 class Primitive
 {
 public:
-	virtual void Intersect(const Ray& ray, HitRecord& record) = 0;
+	virtual ~Primitive() = default;
+	virtual AABB GetBounds() = 0;
 
 	std::string name = "Primitive";
 	vec3 Position;
-	Material Material;
+	::Material Material;
 	PrimitiveType Type;
 
 	bool MarkedForDelete = false;
@@ -2,8 +2,19 @@
 #include "Utilities/Utilities.h"
 #include "Framework/SceneManager.h"
 #include "Graphics/Texture.h"
+#include "Graphics/BVH.h"
+#include "Graphics/Sphere.h"
+#include "Graphics/Plane.h"
+#include "Graphics/TraceStats.h"
 
-#include <imgui.h>
+#include <chrono>
+
+// Balances two sampling strategies, based on how likely each is to produce the same sample //
+static inline float PowerHeuristic(float pdfA, float pdfB)
+{
+	float a2 = pdfA * pdfA;
+	return a2 / (a2 + pdfB * pdfB);
+}
 
 RayTracer::RayTracer(unsigned int screenWidth, unsigned int screenHeight, Scene* scene) : scene(scene)
 {
@@ -11,15 +22,25 @@ RayTracer::RayTracer(unsigned int screenWidth, unsigned int screenHeight, Scene*
 	skydome = &scene->Skydome;
 }
 
-vec3 RayTracer::Trace(int pixelX, int pixelY)
+vec3 RayTracer::Trace(int pixelX, int pixelY, unsigned int sampleIndex, SurfaceFeatures& features)
 {
 	vec3 outputColor;
+	unsigned int seed = CreateSeed(pixelX, pixelY, sampleIndex, randomSeed);
+	unsigned int pixelSeed = CreateSeed(pixelX, pixelY, 0, randomSeed);
+	PathSampler pathSampler(sampler, pixelSeed, sampleIndex, seed);
 
-	Ray ray = camera->GetRay(pixelX, pixelY);
-	HitRecord record;
+	float jitterX, jitterY;
+	pathSampler.GetCamera2D(jitterX, jitterY);
+
+	Ray ray = camera->GetRay(pixelX, pixelY, jitterX, jitterY);
+
+	// Costs accumulate like radiance would, but are never clamped //
+	if(heatmapMode != HeatmapMode::None)
+	{
+		return vec3(TraceCost(ray, pathSampler, features));
+	}
 
-	// Randomly sample a single light from the scene every frame for a pixel //
-	outputColor = TraverseScene(ray, maxRayDepth, record);
+	outputColor = TraverseScene(ray, pathSampler, features);
 
 	outputColor.x = Clamp(outputColor.x, 0.0f, maxLuminance);
 	outputColor.y = Clamp(outputColor.y, 0.0f, maxLuminance);
@@ -30,7 +51,7 @@ vec3 RayTracer::Trace(int pixelX, int pixelY)
 
 Primitive* RayTracer::SelectObject(int pixelX, int pixelY)
 {
-	Ray ray = camera->GetRay(pixelX, pixelY);
+	Ray ray = camera->GetRay(pixelX, pixelY, 0.5f, 0.5f);
 	HitRecord record;
 	record.t = maxT;
 
@@ -38,185 +59,497 @@ Primitive* RayTracer::SelectObject(int pixelX, int pixelY)
 	return record.Primitive;
 }
 
-vec3 RayTracer::TraverseScene(const Ray& ray, int rayDepth, const HitRecord& lastRecord)
+void RayTracer::SetSampler(SamplerType type)
 {
-	if(rayDepth <= 0)
+	samplerType = type;
+
+	switch(type)
 	{
-		// Exceeded bounce limit
-		return vec3(0.0f);
+	case SamplerType::Independent:
+		sampler = &independentSampler;
+		break;
+	case SamplerType::Stratified:
+		sampler = &stratifiedSampler;
+		break;
+	case SamplerType::Sobol:
+		sampler = &sobolSampler;
+		break;
 	}
+}
 
-	int depth = rayDepth - 1;
+SamplerType RayTracer::GetSamplerType()
+{
+	return samplerType;
+}
 
-	HitRecord record;
-	record.t = maxT;
-	record.InsideMedium = lastRecord.InsideMedium;
+/// <summary>
+/// Traces the path like any other sample, but returns how expensive it was according to 'heatmapMode'.
+/// The counting modes read the trace statistics of this thread, so without those they always return 0.
+/// </summary>
+float RayTracer::TraceCost(const Ray& cameraRay, PathSampler& sampler, SurfaceFeatures& features)
+{
+	const TraceStats& stats = TraceStats::Local();
+	unsigned long long tests = stats.PrimitiveTests();
+	unsigned long long rays = stats.CameraRays + stats.BounceRays;
+	auto start = std::chrono::high_resolution_clock::now();
 
-	IntersectScene(ray, record);
+	TraverseScene(cameraRay, sampler, features);
+
+	switch(heatmapMode)
+	{
+	case HeatmapMode::TraceTime:
+		return std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+	case HeatmapMode::IntersectionTests:
+		return float(stats.PrimitiveTests() - tests);
+	case HeatmapMode::PathLength:
+		return float(stats.CameraRays + stats.BounceRays - rays);
+	default:
+		return 0.0f;
+	}
+}
+
+vec3 RayTracer::TraverseScene(const Ray& cameraRay, PathSampler& sampler, SurfaceFeatures& features)
+{
+	Ray ray = cameraRay;
+	vec3 throughput = vec3(1.0f);
+	vec3 radiance = vec3(0.0f);
+
+	// State carried over from the previous bounce //
+	// 'lastBouncePdf' is 0 when the bounce can't be reproduced by direct light sampling (camera & specular)
+	bool insideMedium = false;
+	vec3 lastHitPoint = ray.Origin;
+	float lastBouncePdf = 0.0f;
 
-	vec3 illumination = vec3(0.0f);
+	TRACE_STAT(TraceStats& stats = TraceStats::Local());
+	TRACE_STAT(stats.CameraRays++);
 
-	if(record.t >= maxT)
+	for(int depth = 0; depth < maxRayDepth; depth++)
 	{
-		if(depth == maxRayDepth - 1)
+		sampler.SetDepth(depth);
+
+		// Every ray after the camera ray is a bounce //
+		TRACE_STAT(stats.BounceRays += depth > 0);
+
+		HitRecord record;
+		record.t = maxT;
+		record.InsideMedium = insideMedium;
+
+		IntersectScene(ray, record);
+
+		if(record.t >= maxT)
+		{
+			float skyStrength = depth == 0 ? skydome->SkyDomeBackgroundStrength : skydome->SkyDomeEmission;
+			vec3 sky = throughput * GetSkyColor(ray) * skyStrength;
+
+			if(depth == 0)
+			{
+				features.Albedo = GetSkyColor(ray) * skyStrength;
+				features.Normal = vec3(0.0f);
+				features.Depth = maxT;
+			}
+
+			// After a diffuse bounce the skydome could also have been sampled directly //
+			if(useNextEventEstimation && lastBouncePdf > 0.0f && SamplesSkydome())
+			{
+				float skyPdf = skydome->Pdf(ray.Direction) / float(GetLightCount());
+				sky = sky * PowerHeuristic(lastBouncePdf, skyPdf);
+			}
+
+			radiance += sky;
+			TRACE_STAT(stats.SkyMisses++);
+			break;
+		}
+
+		const Material& material = record.Primitive->Material;
+		vec3 materialColor = material.Color;
+
+		if(material.usesTexture)
 		{
-			illumination += GetSkyColor(ray) * skydome->SkyDomeBackgroundStrength;
+			materialColor = material.texture->Sample(record);
+		}
+
+		if(depth == 0)
+		{
+			features.Albedo = materialColor;
+			features.Normal = record.Normal;
+			features.Depth = record.t;
+		}
+
+		// Emissive Material Model //
+		if(material.isEmissive)
+		{
+			// Emissive materials don't receive shading or bounce
+			// They are considered to be lights.
+			vec3 emission = throughput * materialColor * material.EmissiveStrength;
+
+			// After a diffuse bounce this emitter could also have been sampled directly //
+			if(useNextEventEstimation && lastBouncePdf > 0.0f)
+			{
+				emission = emission * PowerHeuristic(lastBouncePdf, EmitterPdf(lastHitPoint, ray, record));
+			}
+
+			radiance += emission;
+			break;
+		}
+
+		float bouncePdf = 0.0f;
+
+		// Dielectric Material Model //
+		if(material.isDielectric)
+		{
+			// Pick a single lobe with a probability equal to its Fresnel weight,
+			// which cancels out the weight itself.
+			float reflectance = Fresnel(ray.Direction, record.Normal, material.IoR);
+
+			if(sampler.Get1D(BounceDimension::Lobe) < reflectance)
+			{
+				ray = Ray(record.HitPoint, Reflect(ray.Direction, record.Normal));
+			}
+			else
+			{
+				vec3 Rt = Refract(ray.Direction, record.Normal, material.IoR);
+				ray = Ray(record.HitPoint + Rt * EPSILONSMALL, Rt);
+
+				vec3 c = materialColor;
+				if(record.InsideMedium)
+				{
+					float transmittedDistance = (record.HitPoint - lastHitPoint).Magnitude();
+					float beer = expf(-material.Density * transmittedDistance);
+					c = c * beer;
+				}
+
+				throughput = throughput * c;
+			}
 		}
 		else
 		{
-			illumination += GetSkyColor(ray) * skydome->SkyDomeEmission;
+			// Opaque Material Model //
+			float fresnel = Fresnel(ray.Direction, record.Normal, material.IoR);
+			float specularity = min(material.Specularity + fresnel, 1.0f);
+
+			if(sampler.Get1D(BounceDimension::Lobe) >= specularity)
+			{
+				vec3 BRDF = materialColor * INVPI;
+
+				if(useNextEventEstimation)
+				{
+					radiance += throughput * SampleDirectLight(record.HitPoint, record.Normal, BRDF, sampler);
+				}
+
+				float r1, r2;
+				sampler.Get2D(BounceDimension::Direction, r1, r2);
+				vec3 bounceDir = CosineWeightedHemisphere(record.Normal, r1, r2);
+				bouncePdf = Dot(record.Normal, bounceDir) * INVPI;
+
+				// Hemispherical rendering equation // 
+				// BRDF * cosI / pdf, where pdf = cosI / PI, leaves just the albedo
+				throughput = throughput * materialColor;
+				ray = Ray(record.HitPoint, bounceDir);
+			}
+			else
+			{
+				if(material.Roughness > 0.0f)
+				{
+					vec3 offset = RandomUnitVector(sampler.Seed) * material.Roughness;
+					ray = Ray(record.HitPoint, Reflect(Normalize(ray.Direction + offset), record.Normal));
+				}
+				else
+				{
+					ray = Ray(record.HitPoint, Reflect(ray.Direction, record.Normal));
+				}
+
+				if(material.Metalness > 0.0f)
+				{
+					// Metals tint their reflection, regular specular reflections stay white //
+					throughput = throughput * (material.Metalness * materialColor + vec3(1.0f - material.Metalness));
+				}
+			}
 		}
 
-		return illumination;
-	}
+		insideMedium = record.InsideMedium;
+		lastHitPoint = record.HitPoint;
+		lastBouncePdf = bouncePdf;
+
+		// Russian Roulette (Variance Reduction) //
+		// Based on the throughput of the whole path, so a dark surface
+		// in front of a bright light doesn't get its path cut early.
+		if(depth > 0)
+		{
+			float brightestChannel = max(max(throughput.x, throughput.y), throughput.z);
+			float survivalRate = Clamp(brightestChannel, 0.1f, 1.0f);
 
-	const Material& material = record.Primitive->Material;
-	vec3 materialColor = material.Color;
+			if(survivalRate < sampler.Get1D(BounceDimension::RussianRoulette))
+			{
+				TRACE_STAT(stats.RussianRouletteTerminations++);
+				break;
+			}
 
-	if(material.usesTexture)
-	{
-		materialColor = material.texture->Sample(record);
+			throughput = throughput * (1.0f / survivalRate);
+		}
+
+		// Surviving the last bounce means the path got cut off by 'maxRayDepth' //
+		TRACE_STAT(stats.MaxDepthTerminations += depth == maxRayDepth - 1);
 	}
 
-	// Emissive Material Model //
-	if(material.isEmissive)
+	return radiance;
+}
+
+void RayTracer::IntersectScene(const Ray& ray, HitRecord& record)
+{
+	scene->BVH->Intersect(ray, record);
+}
+
+bool RayTracer::Occluded(const Ray& ray, float tMax)
+{
+	return scene->BVH->Occluded(ray, tMax);
+}
+
+/// <summary>
+/// Picks one light, emissive primitive or the skydome uniformly, and returns its contribution towards 'hitPoint'
+/// for a diffuse surface. When the picked light can also be hit by a bounce (emissive primitives & skydome),
+/// the sample is weighted against the BRDF sampling strategy with the power heuristic.
+/// </summary>
+vec3 RayTracer::SampleDirectLight(const vec3& hitPoint, const vec3& normal, const vec3& BRDF, PathSampler& sampler)
+{
+	unsigned int lightCount = GetLightCount();
+	if(lightCount == 0)
 	{
-		// Emissive materials don't receive shading or bounce
-		// They are considered to be lights.
-		return materialColor * material.EmissiveStrength;
+		return vec3(0.0f);
 	}
 
-	// Dielectric Material Model //
-	if(material.isDielectric)
-	{
-		float reflectance = Fresnel(ray.Direction, record.Normal, material.IoR);
-		float transmittance = 1.0f - reflectance;
+	// Drawn up front, 'min' is a macro and would draw a second number //
+	float lightSelect = sampler.Get1D(BounceDimension::LightSelect);
+	unsigned int lightIndex = min((unsigned int)(lightSelect * lightCount), lightCount - 1);
 
-		// Reflection //
-		Ray reflectedRay = Ray(record.HitPoint, Reflect(ray.Direction, record.Normal));
-		illumination += TraverseScene(reflectedRay, depth, record) * reflectance;
+	unsigned int emitterCount = scene->EmissivePrimitives.size();
 
-		// Refraction // 
-		vec3 Rt = Refract(ray.Direction, record.Normal, material.IoR);
-		Ray refractedRay = Ray(record.HitPoint + Rt * EPSILONSMALL, Rt);
+	// Every type of light turns the same two numbers into a point on itself //
+	float r1, r2;
+	sampler.Get2D(BounceDimension::Light, r1, r2);
+
+	vec3 direction;
+	vec3 emission;
+	float distance;
+	float lightPdf;
+	bool canBeHit = false;
+
+	if(lightIndex < scene->Lights.size())
+	{
+		const Light& light = scene->Lights[lightIndex];
+		bool hasArea = light.HasArea && light.Scale.x * light.Scale.z > 0.0f;
 
-		vec3 c = materialColor;
-		if(record.InsideMedium)
+		vec3 lightPoint = light.Position;
+		if(hasArea)
 		{
-			float transmittedDistance = (record.HitPoint - lastRecord.HitPoint).Magnitude();
-			float beer = expf(-material.Density * transmittedDistance);
-			c = c * beer;
+			lightPoint += vec3((r1 - 0.5f) * light.Scale.x, 0.0f, (r2 - 0.5f) * light.Scale.z);
 		}
 
-		illumination += c * TraverseScene(refractedRay, depth, record) * transmittance;
+		vec3 toLight = lightPoint - hitPoint;
+		distance = toLight.Magnitude();
+		direction = toLight * (1.0f / distance);
+		emission = light.Color * light.Intensity;
 
-		return illumination;
+		if(hasArea)
+		{
+			// Area lights face downwards, so the cosine at the light is the Y of the direction //
+			float cosLight = direction.y;
+			if(cosLight <= 0.0f)
+			{
+				return vec3(0.0f);
+			}
+
+			lightPdf = (distance * distance) / (cosLight * light.Scale.x * light.Scale.z);
+		}
+		else
+		{
+			// Point lights fall off with the squared distance //
+			lightPdf = distance * distance;
+		}
+	}
+	else if(lightIndex < scene->Lights.size() + emitterCount)
+	{
+		Primitive* emitter = scene->EmissivePrimitives[lightIndex - scene->Lights.size()];
+		if(!SampleEmitter(emitter, hitPoint, r1, r2, direction, distance, lightPdf))
+		{
+			return vec3(0.0f);
+		}
+
+		emission = emitter->Material.Color * emitter->Material.EmissiveStrength;
+		canBeHit = true;
 	}
+	else
+	{
+		// Importance sample the skydome, the last 'light' //
+		direction = skydome->Sample(r1, r2, lightPdf);
 
-	// Russian Roulette (Variance Reduction) 
-	float multiplier = 1.0f;
-	float brightestChannel = max(max(materialColor.x, materialColor.y), materialColor.z);
-	float survivalRate = Clamp(brightestChannel, 0.1f, 0.9f);
+		if(lightPdf <= 0.0f)
+		{
+			return vec3(0.0f);
+		}
+
+		// Rays that travel 'maxT' count as a miss, so that is as far as the sky needs to be checked //
+		emission = skydome->GetColor(direction) * skydome->SkyDomeEmission;
+		distance = maxT;
+		canBeHit = true;
+	}
 
-	if(survivalRate < Random01())
+	// Stops just short of the light, so an emitter doesn't occlude itself //
+	float cosI = Dot(normal, direction);
+	if(cosI <= 0.0f || Occluded(Ray(hitPoint, direction), distance * 0.999f))
 	{
 		return vec3(0.0f);
 	}
-	multiplier = 1.0f / survivalRate;
 
-	// Opaque Material Model //
-	float fresnel = Fresnel(ray.Direction, record.Normal, material.IoR);
-	float specularity = min(material.Specularity + fresnel, 1.0f);
-	float diffuse = 1.0f - specularity;
+	// The pdf with which the cosine weighted bounce would have picked this direction //
+	float bouncePdf = cosI * INVPI;
 
-	if(diffuse > 0.0f)
+	lightPdf /= float(lightCount);
+	float weight = canBeHit ? PowerHeuristic(lightPdf, bouncePdf) : 1.0f;
+
+	return BRDF * emission * (cosI * weight / lightPdf);
+}
+
+/// <summary>
+/// Samples a direction from 'origin' towards an emissive sphere or plane.
+/// The pdf is with respect to solid angle. Returns false if nothing could be sampled.
+/// </summary>
+bool RayTracer::SampleEmitter(Primitive* emitter, const vec3& origin, float r1, float r2, vec3& direction, float& distance, float& pdf)
+{
+	switch(emitter->Type)
 	{
-		vec3 bounceDir = RandomUnitVector();
-		if(Dot(bounceDir, record.Normal) < 0.0f)
+	case PrimitiveType::Sphere:
+	{
+		// Uniformly sample the cone of directions that the sphere covers //
+		Sphere* sphere = static_cast<Sphere*>(emitter);
+		vec3 toCenter = sphere->Position - origin;
+		float centerDistance2 = toCenter.MagnitudeSquared();
+
+		if(centerDistance2 <= sphere->Radius2)
+		{
+			return false;
+		}
+
+		float centerDistance = sqrtf(centerDistance2);
+		float cosThetaMax = sqrtf(max(1.0f - sphere->Radius2 / centerDistance2, 0.0f));
+		if(cosThetaMax >= 1.0f)
 		{
-			bounceDir = bounceDir * -1.0f;
+			return false;
 		}
 
-		Ray bounceRay = Ray(record.HitPoint, bounceDir);
+		float cosTheta = 1.0f - r1 * (1.0f - cosThetaMax);
+		float sinTheta = sqrtf(max(1.0f - cosTheta * cosTheta, 0.0f));
+		float phi = 2.0f * PI * r2;
+
+		vec3 w = toCenter * (1.0f / centerDistance);
+		vec3 tangent, bitangent;
+		CreateOrthonormalBasis(w, tangent, bitangent);
 
-		vec3 BRDF = diffuse * (materialColor * INVPI);
-		vec3 radiance = TraverseScene(bounceRay, depth, record);
-		float cosI = Dot(record.Normal, bounceDir);
-		const float area = PI * 2.0f;
+		direction = (tangent * cosf(phi) + bitangent * sinf(phi)) * sinTheta + w * cosTheta;
 
-		// Hemispherical rendering equation // 
-		illumination += area * BRDF * radiance * cosI;
+		// Distance to the near side of the sphere along 'direction' //
+		float projection = cosTheta * centerDistance;
+		float offset2 = centerDistance2 - projection * projection;
+		distance = projection - sqrtf(max(sphere->Radius2 - offset2, 0.0f));
+
+		pdf = 1.0f / (2.0f * PI * (1.0f - cosThetaMax));
+		return true;
 	}
 
-	if(specularity > 0.0f)
+	case PrimitiveType::Plane:
 	{
-		Ray reflectRay;
+		// Uniformly sample the area of the plane, and convert the pdf to solid angle //
+		PlaneData plane = static_cast<Plane*>(emitter)->GetData();
+		vec3 lightPoint = plane.v0 + plane.u * (r1 * plane.w) + plane.v * (r2 * plane.h);
 
-		if(material.Roughness > 0.0f)
-		{
-			vec3 offset = RandomUnitVector() * material.Roughness;
-			reflectRay = Ray(record.HitPoint, Reflect(Normalize(ray.Direction + offset), record.Normal));
-		}
-		else
-		{
-			reflectRay = Ray(record.HitPoint, Reflect(ray.Direction, record.Normal));
-		}
+		vec3 toLight = lightPoint - origin;
+		distance = toLight.Magnitude();
+		direction = toLight * (1.0f / distance);
 
-		vec3 radiance = TraverseScene(reflectRay, depth, record);
-		if(material.Metalness > 0.0f)
+		float cosLight = fabsf(Dot(direction, plane.Normal));
+		if(cosLight < 1e-6f)
 		{
-			float metallicness = material.Metalness * specularity;
-			float specular = (1.0f - material.Metalness) * specularity;
-
-			illumination += metallicness * materialColor * radiance;
-			illumination += specular * radiance;
-		}
-		else
-		{
-			illumination += specularity * radiance;
+			return false;
 		}
+
+		pdf = (distance * distance) / (cosLight * plane.w * plane.h);
+		return true;
 	}
 
-	return illumination * multiplier;
+	default:
+		return false;
+	}
 }
 
-void RayTracer::IntersectScene(const Ray& ray, HitRecord& record)
+/// <summary>
+/// The pdf (solid angle) with which 'SampleDirectLight' would have picked the point that
+/// 'ray', leaving 'origin', hit on an emissive primitive. 0 if it can't be sampled directly.
+/// </summary>
+float RayTracer::EmitterPdf(const vec3& origin, const Ray& ray, const HitRecord& record)
 {
-	HitRecord tempRecord;
-	tempRecord.InsideMedium = record.InsideMedium;
+	unsigned int lightCount = GetLightCount();
+	Primitive* emitter = record.Primitive;
+
+	if(lightCount == 0)
+	{
+		return 0.0f;
+	}
 
-	for(Primitive* primitive : scene->primitives)
+	switch(emitter->Type)
 	{
-		primitive->Intersect(ray, tempRecord);
+	case PrimitiveType::Sphere:
+	{
+		Sphere* sphere = static_cast<Sphere*>(emitter);
+		float centerDistance2 = (sphere->Position - origin).MagnitudeSquared();
+
+		if(centerDistance2 <= sphere->Radius2)
+		{
+			return 0.0f;
+		}
 
-		if(tempRecord.t > EPSILON && tempRecord.t < record.t)
+		float cosThetaMax = sqrtf(max(1.0f - sphere->Radius2 / centerDistance2, 0.0f));
+		if(cosThetaMax >= 1.0f)
 		{
-			record = tempRecord;
+			return 0.0f;
 		}
+
+		return 1.0f / (2.0f * PI * (1.0f - cosThetaMax) * lightCount);
 	}
-}
 
-vec3 RayTracer::GetSkyColor(const Ray& ray)
-{
-	if(useSkydomeTexture)
+	case PrimitiveType::Plane:
 	{
-		float theta = acosf(ray.Direction.y);
-		float phi = atan2f(ray.Direction.z, ray.Direction.x) + PI;
+		PlaneData plane = static_cast<Plane*>(emitter)->GetData();
+		float cosLight = fabsf(Dot(ray.Direction, plane.Normal));
 
-		float u = phi / (2 * PI);
-		float v = theta / PI;
+		if(cosLight < 1e-6f)
+		{
+			return 0.0f;
+		}
 
-		u -= skydome->SkydomeOrientation;
+		return (record.t * record.t) / (cosLight * plane.w * plane.h * lightCount);
+	}
 
-		int i = (int)((1.0f - u) * skydome->width);
-		int j = (int)(v * skydome->height);
+	default:
+		return 0.0f;
+	}
+}
 
-		i = i % skydome->width;
-		j = j % skydome->height;
+// Lights, emissive primitives and the skydome, in the order 'SampleDirectLight' indexes them //
+unsigned int RayTracer::GetLightCount()
+{
+	return scene->Lights.size() + scene->EmissivePrimitives.size() + (SamplesSkydome() ? 1 : 0);
+}
+
+bool RayTracer::SamplesSkydome()
+{
+	return useSkydomeTexture && skydome->HasDistribution();
+}
 
-		int index = (i + j * skydome->width) * skydome->comp;
-		vec3 b = vec3(&skydome->image[index]);
-		return b;
+vec3 RayTracer::GetSkyColor(const Ray& ray)
+{
+	// Falls back to the gradient when the skydome failed to load //
+	if(useSkydomeTexture && skydome->image != nullptr)
+	{
+		return skydome->GetColor(ray.Direction);
 	}
 	else
 	{
@@ -5,21 +5,47 @@
 #include "Primitive.h"
 #include "Math/MathCommon.h"
 #include "Camera.h"
+#include "Sampler.h"
+#include "SurfaceFeatures.h"
+#include "Samplers/IndependentSampler.h"
+#include "Samplers/StratifiedSampler.h"
+#include "Samplers/SobolSampler.h"
 
 struct Scene;
 struct Skydome;
 
+// Debug view, what every sample measures instead of radiance //
+enum class HeatmapMode
+{
+	None,
+	TraceTime,			// Microseconds spent on the path
+	IntersectionTests,	// Sphere, plane & triangle tests, including shadow rays
+	PathLength			// Camera & bounce rays along the path
+};
+
 class RayTracer
 {
 public:
 	RayTracer(unsigned int screenWidth, unsigned int screenHeight, Scene* scene);
 
-	vec3 Trace(int pixelX, int pixelY);
+	vec3 Trace(int pixelX, int pixelY, unsigned int sampleIndex, SurfaceFeatures& features);
 	Primitive* SelectObject(int pixelX, int pixelY);
+
+	void SetSampler(SamplerType type);
+	SamplerType GetSamplerType();
 	
 private:
-	vec3 TraverseScene(const Ray& ray, int rayDepth, const HitRecord& lastRecord);
+	vec3 TraverseScene(const Ray& cameraRay, PathSampler& sampler, SurfaceFeatures& features);
+	float TraceCost(const Ray& cameraRay, PathSampler& sampler, SurfaceFeatures& features);
 	void IntersectScene(const Ray& ray, HitRecord& record);
+	bool Occluded(const Ray& ray, float tMax);
+
+	// Next Event Estimation //
+	vec3 SampleDirectLight(const vec3& hitPoint, const vec3& normal, const vec3& BRDF, PathSampler& sampler);
+	bool SampleEmitter(Primitive* emitter, const vec3& origin, float r1, float r2, vec3& direction, float& distance, float& pdf);
+	float EmitterPdf(const vec3& origin, const Ray& ray, const HitRecord& record);
+	unsigned int GetLightCount();
+	bool SamplesSkydome();
 
 	vec3 GetSkyColor(const Ray& ray);
 
@@ -32,10 +58,21 @@ private:
 	float maxT = 100.0f;
 	int maxRayDepth = 16;
 	float maxLuminance = 50.0f;
+	unsigned int randomSeed = 0;
+	bool useNextEventEstimation = true;
+	HeatmapMode heatmapMode = HeatmapMode::None;
+
+	// All samplers stay alive, so workers that are still tracing never see one get deleted
+	IndependentSampler independentSampler;
+	StratifiedSampler stratifiedSampler;
+	SobolSampler sobolSampler;
+	SamplerType samplerType = SamplerType::Sobol;
+	Sampler* sampler = &sobolSampler;
 
 	bool useSkydomeTexture = true;
 	vec3 skyColorA = vec3(0.0f);
 	vec3 skyColorB = vec3(0.84f, 0.72f, 1.0f);
 
 	friend class Editor;
+	friend class BatchRenderer;
 };
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include "Utilities/Utilities.h"
+
+enum class SamplerType
+{
+	Independent,
+	Stratified,
+	Sobol
+};
+
+/// <summary>
+/// Samplers hand out the numbers in [0, 1) that a path consumes. A number is identified by
+/// the pixel, the sample index within that pixel, and the dimension (what the number is used for).
+/// Samplers don't hold any per path state, so a single one gets shared across all workers.
+/// </summary>
+class Sampler
+{
+public:
+	virtual ~Sampler() = default;
+
+	virtual float Get1D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension) = 0;
+	virtual void Get2D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension, float& u, float& v) = 0;
+};
+
+// Every bounce of a path gets the same block of dimensions, so the numbers a
+// dimension represents line up across the samples of a pixel.
+enum class BounceDimension
+{
+	Lobe = 0,
+	LightSelect = 1,
+	Light = 2,				// 2D
+	Direction = 4,			// 2D
+	RussianRoulette = 6,
+	Count = 7
+};
+
+/// <summary>
+/// The state of a single path, walking through the dimensions of its 'sampler'.
+/// 'Seed' is left for anything that doesn't have a fixed amount of numbers, like rejection sampling.
+/// </summary>
+struct PathSampler
+{
+public:
+	PathSampler(Sampler* sampler, unsigned int pixelSeed, unsigned int sampleIndex, unsigned int seed) :
+		Seed(seed), sampler(sampler), pixelSeed(pixelSeed), sampleIndex(sampleIndex) { }
+
+	void SetDepth(int depth) { this->depth = depth; }
+
+	void GetCamera2D(float& u, float& v)
+	{
+		sampler->Get2D(pixelSeed, sampleIndex, 0, u, v);
+	}
+
+	float Get1D(BounceDimension dimension)
+	{
+		return sampler->Get1D(pixelSeed, sampleIndex, GetDimension(dimension));
+	}
+
+	void Get2D(BounceDimension dimension, float& u, float& v)
+	{
+		sampler->Get2D(pixelSeed, sampleIndex, GetDimension(dimension), u, v);
+	}
+
+	unsigned int Seed;
+
+private:
+	unsigned int GetDimension(BounceDimension dimension)
+	{
+		// The first two dimensions are taken by the camera //
+		return 2 + depth * int(BounceDimension::Count) + int(dimension);
+	}
+
+	Sampler* sampler;
+	unsigned int pixelSeed;
+	unsigned int sampleIndex;
+	int depth = 0;
+};
+
+// Hashing helpers shared by the samplers //
+inline unsigned int HashCombine(unsigned int seed, unsigned int value)
+{
+	return seed ^ (WangHash(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+// Uses the top 24 bits, so the result can never round up to 1.0 //
+inline float ToUnitFloat(unsigned int value)
+{
+	return (value >> 8) * (1.0f / 16777216.0f);
+}
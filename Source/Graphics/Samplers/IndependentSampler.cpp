@@ -0,0 +1,14 @@
+#include "IndependentSampler.h"
+
+float IndependentSampler::Get1D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension)
+{
+	unsigned int hash = HashCombine(HashCombine(pixelSeed, sampleIndex), dimension);
+	return ToUnitFloat(WangHash(hash));
+}
+
+void IndependentSampler::Get2D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension, float& u, float& v)
+{
+	unsigned int hash = HashCombine(HashCombine(pixelSeed, sampleIndex), dimension);
+	u = ToUnitFloat(WangHash(hash));
+	v = ToUnitFloat(WangHash(hash ^ 0x68bc21eb));
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "Graphics/Sampler.h"
+
+/// <summary>
+/// Plain Monte Carlo, every number is an independent hash of its pixel, sample & dimension.
+/// </summary>
+class IndependentSampler : public Sampler
+{
+public:
+	float Get1D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension) override;
+	void Get2D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension, float& u, float& v) override;
+};
@@ -0,0 +1,79 @@
+#include "SobolSampler.h"
+
+SobolSampler::SobolSampler()
+{
+	// The direction numbers of the second Sobol dimension follow 'v ^= v >> 1' //
+	unsigned int directions[32];
+	directions[0] = 1u << 31;
+
+	for(int i = 1; i < 32; i++)
+	{
+		directions[i] = directions[i - 1] ^ (directions[i - 1] >> 1);
+	}
+
+	for(int byte = 0; byte < 4; byte++)
+	{
+		for(unsigned int value = 0; value < 256; value++)
+		{
+			unsigned int result = 0;
+
+			for(int bit = 0; bit < 8; bit++)
+			{
+				if(value & (1u << bit))
+				{
+					result ^= directions[byte * 8 + bit];
+				}
+			}
+
+			dimension1Table[byte][value] = ReverseBits(result);
+		}
+	}
+}
+
+// Owen scrambling is a Laine-Karras permutation on the reversed bits. The first Sobol dimension
+// is the reversed index itself, so scrambling it only needs the permutation on the index.
+float SobolSampler::Get1D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension)
+{
+	unsigned int seed = HashCombine(pixelSeed, dimension);
+
+	// Shuffles the order of the points //
+	unsigned int index = ReverseBits(LaineKarrasPermutation(ReverseBits(sampleIndex), seed));
+
+	return ToUnitFloat(ReverseBits(LaineKarrasPermutation(index, HashCombine(seed, 0))));
+}
+
+void SobolSampler::Get2D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension, float& u, float& v)
+{
+	unsigned int seed = HashCombine(pixelSeed, dimension);
+	unsigned int index = ReverseBits(LaineKarrasPermutation(ReverseBits(sampleIndex), seed));
+
+	u = ToUnitFloat(ReverseBits(LaineKarrasPermutation(index, HashCombine(seed, 0))));
+	v = ToUnitFloat(ReverseBits(LaineKarrasPermutation(SobolDimension1Reversed(index), HashCombine(seed, 1))));
+}
+
+unsigned int SobolSampler::ReverseBits(unsigned int value)
+{
+	value = (value << 16) | (value >> 16);
+	value = ((value & 0x00ff00ff) << 8) | ((value & 0xff00ff00) >> 8);
+	value = ((value & 0x0f0f0f0f) << 4) | ((value & 0xf0f0f0f0) >> 4);
+	value = ((value & 0x33333333) << 2) | ((value & 0xcccccccc) >> 2);
+	value = ((value & 0x55555555) << 1) | ((value & 0xaaaaaaaa) >> 1);
+	return value;
+}
+
+unsigned int SobolSampler::SobolDimension1Reversed(unsigned int index)
+{
+	return dimension1Table[0][index & 0xff] ^ dimension1Table[1][(index >> 8) & 0xff] ^
+		dimension1Table[2][(index >> 16) & 0xff] ^ dimension1Table[3][index >> 24];
+}
+
+// Scrambles higher bits based on the lower bits only, which is what Owen scrambling needs in reversed order //
+unsigned int SobolSampler::LaineKarrasPermutation(unsigned int value, unsigned int seed)
+{
+	value += seed;
+	value ^= value * 0x6c50b47c;
+	value ^= value * 0xb82f1e52;
+	value ^= value * 0xc7afe638;
+	value ^= value * 0x8d22f6e6;
+	return value;
+}
\ No newline at end of file
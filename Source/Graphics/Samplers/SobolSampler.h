@@ -0,0 +1,25 @@
+#pragma once
+#include "Graphics/Sampler.h"
+
+/// <summary>
+/// Owen-scrambled Sobol points, following Burley 2020, "Practical Hash-based Owen Scrambling".
+/// Every (pair of) dimension(s) uses the first two Sobol dimensions, with its own shuffled
+/// sample order and its own scramble. This keeps the good 2D stratification of Sobol,
+/// without any correlation between dimensions or pixels.
+/// </summary>
+class SobolSampler : public Sampler
+{
+public:
+	SobolSampler();
+
+	float Get1D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension) override;
+	void Get2D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension, float& u, float& v) override;
+
+private:
+	unsigned int ReverseBits(unsigned int value);
+	unsigned int SobolDimension1Reversed(unsigned int index);
+	unsigned int LaineKarrasPermutation(unsigned int value, unsigned int seed);
+
+	// The second dimension its generator matrix (with reversed output), applied a byte of the index at a time //
+	unsigned int dimension1Table[4][256];
+};
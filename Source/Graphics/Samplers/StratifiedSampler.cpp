@@ -0,0 +1,66 @@
+#include "StratifiedSampler.h"
+
+StratifiedSampler::StratifiedSampler(unsigned int strataPerAxis) :
+	strataPerAxis(max(strataPerAxis, 1u)), strataCount(this->strataPerAxis * this->strataPerAxis) { }
+
+float StratifiedSampler::Get1D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension)
+{
+	unsigned int run = sampleIndex / strataCount;
+	unsigned int hash = HashCombine(HashCombine(pixelSeed, dimension), run);
+
+	unsigned int stratum = Permute(sampleIndex % strataCount, strataCount, hash);
+	float jitter = ToUnitFloat(WangHash(HashCombine(hash, sampleIndex)));
+
+	return (stratum + jitter) / strataCount;
+}
+
+void StratifiedSampler::Get2D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension, float& u, float& v)
+{
+	unsigned int run = sampleIndex / strataCount;
+	unsigned int hash = HashCombine(HashCombine(pixelSeed, dimension), run);
+
+	unsigned int stratum = Permute(sampleIndex % strataCount, strataCount, hash);
+	unsigned int jitterHash = HashCombine(hash, sampleIndex);
+
+	u = ((stratum % strataPerAxis) + ToUnitFloat(WangHash(jitterHash))) / strataPerAxis;
+	v = ((stratum / strataPerAxis) + ToUnitFloat(WangHash(jitterHash ^ 0x68bc21eb))) / strataPerAxis;
+}
+
+/// <summary>
+/// A random permutation of [0, length) without storing it, from Kensler 2013,
+/// "Correlated Multi-Jittered Sampling". Hashes within the next power of two, and
+/// cycles until the result lands inside of the range.
+/// </summary>
+unsigned int StratifiedSampler::Permute(unsigned int index, unsigned int length, unsigned int seed)
+{
+	unsigned int mask = length - 1;
+	mask |= mask >> 1;
+	mask |= mask >> 2;
+	mask |= mask >> 4;
+	mask |= mask >> 8;
+	mask |= mask >> 16;
+
+	do
+	{
+		index ^= seed;
+		index *= 0xe170893d;
+		index ^= seed >> 16;
+		index ^= (index & mask) >> 4;
+		index ^= seed >> 8;
+		index *= 0x0929eb3f;
+		index ^= seed >> 23;
+		index ^= (index & mask) >> 1;
+		index *= 1 | seed >> 27;
+		index *= 0x6935fa69;
+		index ^= (index & mask) >> 11;
+		index *= 0x74dcb303;
+		index ^= (index & mask) >> 2;
+		index *= 0x9e501cc3;
+		index ^= (index & mask) >> 2;
+		index *= 0xc860a3df;
+		index &= mask;
+		index ^= index >> 5;
+	} while(index >= length);
+
+	return (index + seed) % length;
+}
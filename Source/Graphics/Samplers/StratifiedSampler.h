@@ -0,0 +1,21 @@
+#pragma once
+#include "Graphics/Sampler.h"
+
+/// <summary>
+/// Jittered stratification. Every run of 'strataPerAxis * strataPerAxis' samples of a pixel
+/// visits each stratum once, in an order that is shuffled per pixel, dimension & run.
+/// </summary>
+class StratifiedSampler : public Sampler
+{
+public:
+	StratifiedSampler(unsigned int strataPerAxis = 4);
+
+	float Get1D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension) override;
+	void Get2D(unsigned int pixelSeed, unsigned int sampleIndex, unsigned int dimension, float& u, float& v) override;
+
+private:
+	unsigned int Permute(unsigned int index, unsigned int length, unsigned int seed);
+
+	unsigned int strataPerAxis;
+	unsigned int strataCount;
+};
@@ -0,0 +1,142 @@
+#include "Skydome.h"
+#include "Math/MathCommon.h"
+
+#include <algorithm>
+#include <cmath>
+
+void Skydome::BuildDistribution()
+{
+	conditionalCDF.clear();
+	marginalCDF.clear();
+	weightTotal = 0.0f;
+
+	if(!image || width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	conditionalCDF.resize((width + 1) * height);
+	marginalCDF.resize(height + 1);
+	marginalCDF[0] = 0.0f;
+
+	for(int y = 0; y < height; y++)
+	{
+		float* rowCDF = &conditionalCDF[y * (width + 1)];
+		rowCDF[0] = 0.0f;
+
+		for(int x = 0; x < width; x++)
+		{
+			rowCDF[x + 1] = rowCDF[x] + GetWeight(x, y);
+		}
+
+		float rowTotal = rowCDF[width];
+		marginalCDF[y + 1] = marginalCDF[y] + rowTotal;
+
+		// Black rows (like the poles) fall back to being uniform //
+		for(int x = 1; x <= width; x++)
+		{
+			rowCDF[x] = rowTotal > 0.0f ? rowCDF[x] / rowTotal : float(x) / width;
+		}
+	}
+
+	weightTotal = marginalCDF[height];
+	if(weightTotal <= 0.0f)
+	{
+		conditionalCDF.clear();
+		marginalCDF.clear();
+		return;
+	}
+
+	for(int y = 1; y <= height; y++)
+	{
+		marginalCDF[y] /= weightTotal;
+	}
+}
+
+bool Skydome::HasDistribution() const
+{
+	return !marginalCDF.empty();
+}
+
+int Skydome::GetPixelIndex(const vec3& direction) const
+{
+	float theta = acosf(direction.y);
+	float phi = atan2f(direction.z, direction.x) + PI;
+
+	float u = phi / (2 * PI);
+	float v = theta / PI;
+
+	u -= SkydomeOrientation;
+
+	int i = (int)((1.0f - u) * width);
+	int j = (int)(v * height);
+
+	i = i % width;
+	j = j % height;
+
+	return i + j * width;
+}
+
+vec3 Skydome::GetColor(const vec3& direction) const
+{
+	return vec3(&image[GetPixelIndex(direction) * comp]);
+}
+
+/// <summary>
+/// Picks a direction proportional to the distribution, 'pdf' is with respect to solid angle.
+/// </summary>
+vec3 Skydome::Sample(float r1, float r2, float& pdf) const
+{
+	// Row first, then the pixel within that row //
+	int y = int(std::upper_bound(marginalCDF.begin(), marginalCDF.end(), r1) - marginalCDF.begin()) - 1;
+	y = std::clamp(y, 0, height - 1);
+
+	const float* rowCDF = &conditionalCDF[y * (width + 1)];
+	int x = int(std::upper_bound(rowCDF, rowCDF + width + 1, r2) - rowCDF) - 1;
+	x = std::clamp(x, 0, width - 1);
+
+	// Reuse the random numbers for the position within the pixel //
+	float rowWidth = marginalCDF[y + 1] - marginalCDF[y];
+	float pixelWidth = rowCDF[x + 1] - rowCDF[x];
+	float dy = rowWidth > 0.0f ? (r1 - marginalCDF[y]) / rowWidth : 0.5f;
+	float dx = pixelWidth > 0.0f ? (r2 - rowCDF[x]) / pixelWidth : 0.5f;
+
+	float theta = (y + std::clamp(dy, 0.0f, 1.0f)) / height * PI;
+	float u = 1.0f - (x + std::clamp(dx, 0.0f, 1.0f)) / width;
+	float phi = (u + SkydomeOrientation) * 2.0f * PI - PI;
+
+	float sinTheta = sinf(theta);
+	if(sinTheta <= 0.0f)
+	{
+		pdf = 0.0f;
+		return vec3(0.0f, 1.0f, 0.0f);
+	}
+
+	// From image space to solid angle: d(omega) = 2 * PI * PI * sin(theta) du dv //
+	pdf = GetWeight(x, y) / weightTotal * (width * height) / (2.0f * PI * PI * sinTheta);
+	return vec3(cosf(phi) * sinTheta, cosf(theta), sinf(phi) * sinTheta);
+}
+
+float Skydome::Pdf(const vec3& direction) const
+{
+	float sinTheta = sqrtf(std::max(1.0f - direction.y * direction.y, 0.0f));
+	if(sinTheta <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	int index = GetPixelIndex(direction);
+	float weight = GetWeight(index % width, index / width);
+
+	return weight / weightTotal * (width * height) / (2.0f * PI * PI * sinTheta);
+}
+
+// Luminance, scaled by the solid angle a row covers //
+float Skydome::GetWeight(int x, int y) const
+{
+	const float* pixel = &image[(x + y * width) * comp];
+	float luminance = 0.2126f * pixel[0] + 0.7152f * pixel[1] + 0.0722f * pixel[2];
+	float sinTheta = sinf((y + 0.5f) / height * PI);
+
+	return luminance * sinTheta;
+}
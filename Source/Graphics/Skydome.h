@@ -0,0 +1,40 @@
+#pragma once
+#include "Math/Vec3.h"
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Equirectangular HDR environment. Besides the image, it holds a 2D distribution
+/// over its pixels (weighted by luminance * sin(theta)), so bright regions such
+/// as the softboxes of a studio can be sampled directly by the ray tracer.
+/// </summary>
+struct Skydome
+{
+public:
+	void BuildDistribution();
+	bool HasDistribution() const;
+
+	int GetPixelIndex(const vec3& direction) const;
+	vec3 GetColor(const vec3& direction) const;
+
+	vec3 Sample(float r1, float r2, float& pdf) const;
+	float Pdf(const vec3& direction) const;
+
+	std::string Name = "Studio";
+	int width = 0, height = 0, comp;
+	float* image = nullptr;
+
+	// Skydome //
+	float SkydomeOrientation = 0.0f;
+	float SkyDomeEmission = 1.0f;
+	float SkyDomeBackgroundStrength = 1.0f;
+
+private:
+	float GetWeight(int x, int y) const;
+
+	// Per row a CDF over its pixels ('width + 1' entries each),
+	// and a CDF over the rows themselves ('height + 1' entries).
+	std::vector<float> conditionalCDF;
+	std::vector<float> marginalCDF;
+	float weightTotal = 0.0f;
+};
@@ -7,7 +7,7 @@ public:
 	Sphere(vec3 position, float radius);
 	Sphere(vec3 position, float radius, vec3 color);
 
-	virtual void Intersect(const Ray& ray, HitRecord& record) override;
+	virtual AABB GetBounds() override;
 
 	float Radius;
 	float Radius2;
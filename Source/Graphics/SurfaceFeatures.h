@@ -0,0 +1,21 @@
+#pragma once
+#include "Math/Vec3.h"
+
+/// <summary>
+/// What the camera ray hit first, written alongside the color of every sample.
+/// Accumulated like the color, then averaged, these guide the denoiser:
+/// an edge in any of them is an edge it shouldn't blur across.
+/// </summary>
+struct SurfaceFeatures
+{
+	vec3 Albedo;
+	vec3 Normal;
+	float Depth = 0.0f;
+
+	inline void operator+=(const SurfaceFeatures& rh)
+	{
+		Albedo += rh.Albedo;
+		Normal += rh.Normal;
+		Depth += rh.Depth;
+	}
+};
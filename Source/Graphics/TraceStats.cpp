@@ -0,0 +1,134 @@
+#include "TraceStats.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Every counter of 'TraceStats', so they can be merged & summed in a loop //
+static unsigned long long TraceStats::* const traceStatFields[] =
+{
+	&TraceStats::CameraRays,
+	&TraceStats::BounceRays,
+	&TraceStats::ShadowRays,
+	&TraceStats::OccludedShadowRays,
+	&TraceStats::SkyMisses,
+	&TraceStats::RussianRouletteTerminations,
+	&TraceStats::MaxDepthTerminations,
+	&TraceStats::NodesVisited,
+	&TraceStats::ShadowNodesVisited,
+	&TraceStats::SphereTests,
+	&TraceStats::PlaneTests,
+	&TraceStats::TriangleTests
+};
+
+static constexpr unsigned int traceStatCount = sizeof(traceStatFields) / sizeof(traceStatFields[0]);
+static_assert(sizeof(TraceStats) == traceStatCount * sizeof(unsigned long long), "Every TraceStats counter needs to be listed in 'traceStatFields'");
+
+TraceStats& TraceStats::operator+=(const TraceStats& rh)
+{
+	for(unsigned int i = 0; i < traceStatCount; i++)
+	{
+		this->*traceStatFields[i] += rh.*traceStatFields[i];
+	}
+
+	return *this;
+}
+
+#if USE_TRACE_STATS
+
+// The flushed totals of a single thread, on their own cache line(s) so threads never share one.
+// Only its owner writes to it, relaxed loads & stores keep that as cheap as plain adds.
+struct alignas(64) TraceStatsSlot
+{
+	std::atomic<unsigned long long> Counters[traceStatCount] = {};
+	bool InUse = true;
+};
+
+// Hands the slot back once its thread exits, its totals stay in there & the next new thread adds on top of them //
+struct TraceStatsSlotOwner
+{
+	TraceStatsSlot* Slot = nullptr;
+	~TraceStatsSlotOwner();
+};
+
+static std::mutex traceStatsLock;
+static std::vector<std::unique_ptr<TraceStatsSlot>> traceStatsSlots;
+static thread_local TraceStatsSlotOwner localTraceStatsSlot;
+
+TraceStatsSlotOwner::~TraceStatsSlotOwner()
+{
+	if(Slot)
+	{
+		std::lock_guard<std::mutex> lock(traceStatsLock);
+		Slot->InUse = false;
+	}
+}
+
+static TraceStatsSlot& GetLocalSlot()
+{
+	if(!localTraceStatsSlot.Slot)
+	{
+		std::lock_guard<std::mutex> lock(traceStatsLock);
+
+		for(auto& slot : traceStatsSlots)
+		{
+			if(!slot->InUse)
+			{
+				slot->InUse = true;
+				localTraceStatsSlot.Slot = slot.get();
+				return *slot;
+			}
+		}
+
+		traceStatsSlots.push_back(std::make_unique<TraceStatsSlot>());
+		localTraceStatsSlot.Slot = traceStatsSlots.back().get();
+	}
+
+	return *localTraceStatsSlot.Slot;
+}
+
+void TraceStats::Flush()
+{
+	TraceStatsSlot& slot = GetLocalSlot();
+	TraceStats& local = Local();
+
+	for(unsigned int i = 0; i < traceStatCount; i++)
+	{
+		std::atomic<unsigned long long>& counter = slot.Counters[i];
+		counter.store(counter.load(std::memory_order_relaxed) + local.*traceStatFields[i], std::memory_order_relaxed);
+	}
+
+	local = TraceStats();
+}
+
+TraceStats TraceStats::Gather()
+{
+	std::lock_guard<std::mutex> lock(traceStatsLock);
+	TraceStats stats;
+
+	for(auto& slot : traceStatsSlots)
+	{
+		for(unsigned int i = 0; i < traceStatCount; i++)
+		{
+			stats.*traceStatFields[i] += slot->Counters[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	return stats;
+}
+
+void TraceStats::Reset()
+{
+	std::lock_guard<std::mutex> lock(traceStatsLock);
+
+	for(auto& slot : traceStatsSlots)
+	{
+		for(unsigned int i = 0; i < traceStatCount; i++)
+		{
+			slot->Counters[i].store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+// Counts what the ray tracer & BVH do per ray, see 'TraceStats'.
+// Set to false to compile every counter away.
+#ifndef USE_TRACE_STATS
+#define USE_TRACE_STATS true
+#endif
+
+// Only evaluates 'statement' when trace statistics are enabled, e.g. TRACE_STAT(stats.CameraRays++) //
+#if USE_TRACE_STATS
+#define TRACE_STAT(statement) statement
+#else
+#define TRACE_STAT(statement)
+#endif
+
+/// <summary>
+/// Hot-path counters of the ray tracer & BVH. Every thread counts into its own thread-local
+/// copy with plain adds, which 'Flush' merges into a cache-line-padded slot of that thread once
+/// per tile sample. 'Gather' sums up those slots, so reading never stalls the workers.
+/// </summary>
+struct TraceStats
+{
+	// Rays //
+	unsigned long long CameraRays = 0;
+	unsigned long long BounceRays = 0;
+	unsigned long long ShadowRays = 0;
+	unsigned long long OccludedShadowRays = 0;
+
+	// Path Terminations //
+	unsigned long long SkyMisses = 0;
+	unsigned long long RussianRouletteTerminations = 0;
+	unsigned long long MaxDepthTerminations = 0;
+
+	// BVH //
+	unsigned long long NodesVisited = 0;
+	unsigned long long ShadowNodesVisited = 0;
+	unsigned long long SphereTests = 0;
+	unsigned long long PlaneTests = 0; // Includes infinite planes
+	unsigned long long TriangleTests = 0;
+
+	TraceStats& operator+=(const TraceStats& rh);
+
+	unsigned long long PrimitiveTests() const { return SphereTests + PlaneTests + TriangleTests; }
+
+	// The counters of the calling thread, which haven't been flushed yet //
+	static TraceStats& Local()
+	{
+		static thread_local TraceStats local;
+		return local;
+	}
+
+#if USE_TRACE_STATS
+	static void Flush();
+	static TraceStats Gather();
+	static void Reset();
+#else
+	static void Flush() {}
+	static TraceStats Gather() { return TraceStats(); }
+	static void Reset() {}
+#endif
+};
@@ -1,14 +1,61 @@
 #pragma once
 #include "Primitive.h"
 
+/// <summary>
+/// Everything needed to intersect a Triangle, stored contiguously by the BVH.
+/// </summary>
+struct TriangleData
+{
+	vec3 v0;
+	vec3 e1, e2;
+	vec3 Normal;
+};
+
 class Triangle : public Primitive
 {
 public:
 	Triangle(vec3 v0, vec3 v1, vec3 v2);
-	virtual void Intersect(const Ray& ray, HitRecord& record) override;
+
+	virtual AABB GetBounds() override;
+	TriangleData GetData() const;
 
 private:
 	vec3 Normal;
 	vec3 v0, v1, v2;
 	vec3 e1, e2;
-};
\ No newline at end of file
+};
+
+// Returns the distance along the ray, or -1 on a miss.
+// On a hit, 'weightU' & 'weightV' hold the barycentric coordinates of the hit point.
+inline float IntersectTriangle(const TriangleData& triangle, const Ray& ray, float& weightU, float& weightV)
+{
+	vec3 h = Cross(ray.Direction, triangle.e2);
+	float area = Dot(triangle.e1, h);
+
+	if(area > -EPSILON && area < EPSILON)
+	{
+		return -1.0f;
+	}
+
+	float f = 1.0f / area;
+	vec3 s = ray.Origin - triangle.v0;
+	weightU = f * Dot(s, h);
+
+	if(weightU < 0.0f || weightU > 1.0f)
+	{
+		// Weights don't add up to 1, thus the point is outside te triangle.
+		return -1.0f;
+	}
+
+	vec3 q = Cross(s, triangle.e1);
+	weightV = f * Dot(ray.Direction, q);
+
+	if(weightV < 0.0f || weightU + weightV > 1.0f)
+	{
+		// Weights don't add up to 1, thus the point is outside te triangle.
+		return -1.0f;
+	}
+
+	float t = f * Dot(triangle.e2, q);
+	return t > EPSILON ? t : -1.0f;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "Vec3.h"
+#include <cmath>
+#include <cfloat>
+
+/// <summary>
+/// Axis aligned bounding box, used by the acceleration structure(s)
+/// to quickly discard rays that can never hit the geometry inside of it.
+/// </summary>
+struct AABB
+{
+public:
+	AABB() : Min(vec3(FLT_MAX)), Max(vec3(-FLT_MAX)) {}
+	AABB(const vec3& min, const vec3& max) : Min(min), Max(max) {}
+
+	void Grow(const vec3& point)
+	{
+		Min = vec3(fminf(Min.x, point.x), fminf(Min.y, point.y), fminf(Min.z, point.z));
+		Max = vec3(fmaxf(Max.x, point.x), fmaxf(Max.y, point.y), fmaxf(Max.z, point.z));
+	}
+
+	// Growing by an empty box, such as an unused SAH bin, leaves this box unchanged //
+	void Grow(const AABB& box)
+	{
+		Min = vec3(fminf(Min.x, box.Min.x), fminf(Min.y, box.Min.y), fminf(Min.z, box.Min.z));
+		Max = vec3(fmaxf(Max.x, box.Max.x), fmaxf(Max.y, box.Max.y), fmaxf(Max.z, box.Max.z));
+	}
+
+	vec3 Center() const
+	{
+		return (Min + Max) * 0.5f;
+	}
+
+	// Half of the surface area is enough for the SAH, since it only compares ratios //
+	float HalfArea() const
+	{
+		vec3 e = Max - Min;
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+
+	bool IsValid() const
+	{
+		return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z;
+	}
+
+	vec3 Min;
+	vec3 Max;
+};
@@ -1,44 +1,207 @@
 #pragma once
+#include <cmath>
 
-struct Vec3
+// When enabled, Vec3 is backed by a 128-bit SSE register.
+// Set to false to benchmark against the plain scalar implementation.
+#ifndef USE_SIMD_VEC3
+#define USE_SIMD_VEC3 true
+#endif
+
+#if USE_SIMD_VEC3
+#include <immintrin.h>
+#endif
+
+struct alignas(16) Vec3
 {
 public:
-	Vec3();
-	Vec3(float v);
-	Vec3(float* v);
-	Vec3(float x, float y, float z);
+#if USE_SIMD_VEC3
+	Vec3() : simd(_mm_setzero_ps()) {}
+	Vec3(float v) : simd(_mm_set_ps(0.0f, v, v, v)) {}
+	Vec3(float x, float y, float z) : simd(_mm_set_ps(0.0f, z, y, x)) {}
+	Vec3(__m128 v) : simd(v) {}
+#else
+	Vec3() : x(0.0f), y(0.0f), z(0.0f), dummy(0.0f) {}
+	Vec3(float v) : x(v), y(v), z(v), dummy(0.0f) {}
+	Vec3(float x, float y, float z) : x(x), y(y), z(z), dummy(0.0f) {}
+#endif
+	Vec3(float* v) : Vec3(v[0], v[1], v[2]) {}
 
-	Vec3(const Vec3& rh);
-	Vec3& operator=(const Vec3& rh);
-	void operator+=(const Vec3& rh);
+	inline void operator+=(const Vec3& rh);
 
-	float Magnitude() const;
-	float MagnitudeSquared() const;
-	void Normalize();
+	inline float Magnitude() const;
+	inline float MagnitudeSquared() const;
+	inline void Normalize();
 
 #pragma warning (push)
 #pragma warning (disable:4201)
+	// 'dummy' is always kept at 0, so it never pollutes horizontal operations like Dot
+#if USE_SIMD_VEC3
+	union { struct { float x, y, z, dummy; }; float data[4]; __m128 simd; };
+#else
 	union { struct { float x, y, z, dummy; }; float data[4]; };
+#endif
 #pragma warning (pop)
 };
 
 typedef Vec3 vec3;
 
+#if USE_SIMD_VEC3
+inline vec3 operator+(const vec3& lh, const vec3& rh) { return vec3(_mm_add_ps(lh.simd, rh.simd)); }
+inline vec3 operator-(const vec3& lh, const vec3& rh) { return vec3(_mm_sub_ps(lh.simd, rh.simd)); }
+inline vec3 operator*(const vec3& lh, float rh) { return vec3(_mm_mul_ps(lh.simd, _mm_set1_ps(rh))); }
+inline vec3 operator*(const vec3& lh, const vec3& rh) { return vec3(_mm_mul_ps(lh.simd, rh.simd)); }
+
+inline void Vec3::operator+=(const Vec3& rh) { simd = _mm_add_ps(simd, rh.simd); }
+
+inline float Dot(const vec3& lh, const vec3& rh)
+{
+	// Horizontal add without SSE4's '_mm_dp_ps' //
+	__m128 m = _mm_mul_ps(lh.simd, rh.simd);
+	__m128 shuffle = _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1));
+	__m128 sums = _mm_add_ps(m, shuffle);
+	shuffle = _mm_movehl_ps(shuffle, sums);
+	sums = _mm_add_ss(sums, shuffle);
+	return _mm_cvtss_f32(sums);
+}
+
+inline vec3 Cross(const vec3& lh, const vec3& rh)
+{
+	__m128 lhYZX = _mm_shuffle_ps(lh.simd, lh.simd, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 rhYZX = _mm_shuffle_ps(rh.simd, rh.simd, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 c = _mm_sub_ps(_mm_mul_ps(lh.simd, rhYZX), _mm_mul_ps(lhYZX, rh.simd));
+	return vec3(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+}
+#else
 inline vec3 operator+(const vec3& lh, const vec3& rh) { return vec3(lh.x + rh.x, lh.y + rh.y, lh.z + rh.z); }
 inline vec3 operator-(const vec3& lh, const vec3& rh) { return vec3(lh.x - rh.x, lh.y - rh.y, lh.z - rh.z); }
 inline vec3 operator*(const vec3& lh, float rh) { return vec3(lh.x * rh, lh.y * rh, lh.z * rh); }
 inline vec3 operator*(const vec3& lh, const vec3& rh) { return vec3(lh.x * rh.x, lh.y * rh.y, lh.z * rh.z); }
 
-float Dot(const vec3& lh, const vec3& rh);
-vec3 Cross(const vec3& lh, const vec3& rh);
-vec3 Reflect(const vec3& in, const vec3& normal);
-vec3 Refract(const vec3& in, const vec3& normal, float IoR);
-vec3 Normalize(const vec3& n);
-float Fresnel(const vec3& in, const vec3& normal, float IoR);
+inline void Vec3::operator+=(const Vec3& rh)
+{
+	x += rh.x;
+	y += rh.y;
+	z += rh.z;
+}
 
-vec3 RandomUnitVector();
-vec3 SphericalToCartesian(float theta, float phi);
+inline float Dot(const vec3& lh, const vec3& rh)
+{
+	return lh.x * rh.x + lh.y * rh.y + lh.z * rh.z;
+}
+
+inline vec3 Cross(const vec3& lh, const vec3& rh)
+{
+	float x = lh.y * rh.z - lh.z * rh.y;
+	float y = lh.z * rh.x - lh.x * rh.z;
+	float z = lh.x * rh.y - lh.y * rh.x;
+
+	return vec3(x, y, z);
+}
+#endif
+
+inline float Vec3::Magnitude() const
+{
+	return sqrtf(Dot(*this, *this));
+}
+
+inline float Vec3::MagnitudeSquared() const
+{
+	return Dot(*this, *this);
+}
+
+inline void Vec3::Normalize()
+{
+	*this = *this * (1.0f / Magnitude());
+}
+
+inline vec3 Normalize(const vec3& n)
+{
+	return n * (1.0f / n.Magnitude());
+}
 
-// To do:
-// Operator overloading
-// proper copy & assignment constructor
\ No newline at end of file
+inline vec3 Reflect(const vec3& in, const vec3& normal)
+{
+	return in - normal * (2.0f * Dot(in, normal));
+}
+
+inline vec3 Refract(const vec3& in, const vec3& normal, float IoR)
+{
+	float cosI = Dot(in, normal);
+	float n1 = 1.0f;
+	float n2 = IoR;
+	vec3 norm = normal;
+
+	if (cosI < 0.0f)
+	{
+		// Going from air into medium
+		cosI = -cosI;
+	}
+	else
+	{
+		// Going from medium back into air
+		float t = n1;
+		n1 = n2;
+		n2 = t;
+		norm = norm * -1.0f;
+	}
+
+	float eta = n1 / n2;
+	float k = 1.0f - eta * eta * (1.0f - cosI * cosI);
+
+	if (k < 0.0f)
+	{
+		return Reflect(in, norm);
+	}
+
+	vec3 a = (in + norm * cosI) * eta;
+	vec3 b = norm * -sqrtf(k);
+
+	return a + b;
+}
+
+// Returns the amount of Reflectance from fresnel
+// using this value, compute the transmitance by doing: '1.0 - Reflectance'
+inline float Fresnel(const vec3& in, const vec3& normal, float IoR)
+{
+	float cosI = Dot(in, normal);
+	float n1 = 1.0f;
+	float n2 = IoR;
+
+	if (cosI > 0.0f)
+	{
+		float t = n1;
+		n1 = n2;
+		n2 = t;
+	}
+
+	float sinR = n1 / n2 * sqrtf(fmaxf(1.0f - cosI * cosI, 0.0f));
+	if (sinR >= 1.0f)
+	{
+		// TIR, aka perfect reflectance, which happens at the exact edges of a surface.
+		return 1.0f;
+	}
+
+	float cosR = sqrtf(fmaxf(1.0f - sinR * sinR, 0.0f));
+	cosI = fabsf(cosI);
+
+	float Fp = (n2 * cosI - n1 * cosR) / (n2 * cosI + n1 * cosR);
+	float Fr = (n1 * cosI - n2 * cosR) / (n1 * cosI + n2 * cosR);
+
+	return (Fp * Fp + Fr * Fr) * 0.5f;
+}
+
+// Builds two vectors that, together with the (normalized) 'n', form an orthonormal basis.
+// Branchless construction from Duff et al. 2017, "Building an Orthonormal Basis, Revisited"
+inline void CreateOrthonormalBasis(const vec3& n, vec3& tangent, vec3& bitangent)
+{
+	float sign = copysignf(1.0f, n.z);
+	float a = -1.0f / (sign + n.z);
+	float b = n.x * n.y * a;
+
+	tangent = vec3(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+	bitangent = vec3(b, sign + n.y * n.y * a, -n.y);
+}
+
+vec3 RandomUnitVector(unsigned int& seed);
+vec3 CosineWeightedHemisphere(const vec3& normal, float r1, float r2);
+vec3 SphericalToCartesian(float theta, float phi);
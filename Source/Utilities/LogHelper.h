@@ -3,11 +3,22 @@
 // Github: https://github.com/WhatevvsDev
 
 #include <string>
+#include <cstdio>
+
+#ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #define VC_EXTRALEAN
 #endif
 #include <Windows.h>
+#else
+#include <type_traits>
+
+// Stand-ins for the 'min' & 'max' macros from Windows.h, which the rest of the code relies on.
+// Functions rather than macros, since other standard libraries don't guard against those.
+template<typename A, typename B> inline typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+template<typename A, typename B> inline typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+#endif
 
 #define LOG_IN_RELEASE true
 
@@ -22,6 +33,7 @@ namespace Log
 
 	namespace
 	{
+#ifdef _WIN32
 		// Get Windows Console specific attribute for different text color
 		WORD type_to_color(MessageType aType)
 		{
@@ -36,24 +48,44 @@ namespace Log
 				return 12;
 			}
 		}
+#else
+		// Get ANSI escape code for the same colors on other terminals
+		const char* type_to_color(MessageType aType)
+		{
+			switch (aType)
+			{
+			default:
+			case MessageType::Default:
+				return "\033[90m";
+			case MessageType::Debug:
+				return "\033[93m";
+			case MessageType::Error:
+				return "\033[91m";
+			}
+		}
+#endif
 	}
 
 	inline void print(MessageType aType, const char* aFile, int aLineNumber, const std::string& aMessage)
 	{
 #if _DEBUG || LOG_IN_RELEASE
+		// Get only file name
+		std::string fileName { aFile };
+		fileName = fileName.substr(fileName.find_last_of("/\\") + 1).c_str();
+
+#ifdef _WIN32
 		HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
 
 		// Modify color of text
 		WORD attribute = type_to_color(aType);
 		SetConsoleTextAttribute(handle, attribute);
 
-		// Get only file name
-		std::string fileName { aFile };
-		fileName = fileName.substr(fileName.find_last_of("/\\") + 1).c_str();
-
 		// Print and reset color
 		printf("[%s: %i] - %s\n", fileName.c_str(), aLineNumber, aMessage.c_str());
 		SetConsoleTextAttribute(handle, 15);
+#else
+		printf("%s[%s: %i] - %s\033[0m\n", type_to_color(aType), fileName.c_str(), aLineNumber, aMessage.c_str());
+#endif
 #endif
 	}
 }
@@ -0,0 +1,160 @@
+#include "Profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct ProfileEvent
+{
+	const char* Name;
+	long long Start;
+	long long Duration;
+};
+
+/// <summary>
+/// Single producer ring, only the owning thread ever writes to it. 'Head' gets published after
+/// the event is written, so a dump can read alongside the owner, and afterwards throws away
+/// whatever the owner might have overwritten in the meantime.
+/// </summary>
+struct ProfileRing
+{
+	ProfileEvent Events[Profiler::EventCapacity];
+	std::atomic<unsigned long long> Head{ 0 };
+
+	unsigned int ThreadIndex = 0;
+	std::string ThreadName;
+	bool InUse = true;
+};
+
+// Hands the ring back once its thread exits, so restarted workers reuse the rings of the old ones //
+struct RingOwner
+{
+	ProfileRing* Ring = nullptr;
+	~RingOwner();
+};
+
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+static std::mutex ringsLock;
+static std::vector<std::unique_ptr<ProfileRing>> rings;
+static thread_local RingOwner localRing;
+
+RingOwner::~RingOwner()
+{
+	if(Ring)
+	{
+		std::lock_guard<std::mutex> lock(ringsLock);
+		Ring->InUse = false;
+	}
+}
+
+static ProfileRing& GetLocalRing()
+{
+	if(!localRing.Ring)
+	{
+		std::lock_guard<std::mutex> lock(ringsLock);
+
+		for(auto& ring : rings)
+		{
+			if(!ring->InUse)
+			{
+				ring->InUse = true;
+				localRing.Ring = ring.get();
+				return *ring;
+			}
+		}
+
+		rings.push_back(std::make_unique<ProfileRing>());
+		localRing.Ring = rings.back().get();
+		localRing.Ring->ThreadIndex = rings.size() - 1;
+		localRing.Ring->ThreadName = "Thread " + std::to_string(rings.size() - 1);
+	}
+
+	return *localRing.Ring;
+}
+
+long long Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::RecordZone(const char* name, long long start, long long end)
+{
+	ProfileRing& ring = GetLocalRing();
+	unsigned long long head = ring.Head.load(std::memory_order_relaxed);
+
+	ring.Events[head % EventCapacity] = { name, start, end - start };
+	ring.Head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	ProfileRing& ring = GetLocalRing();
+
+	std::lock_guard<std::mutex> lock(ringsLock);
+	ring.ThreadName = name;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+	std::ofstream trace(path);
+	if(!trace.is_open())
+	{
+		return false;
+	}
+
+	// Timestamps are in microseconds, the fractions keep the nanoseconds //
+	char line[256];
+	bool firstEvent = true;
+
+	auto writeEvent = [&](const char* event)
+	{
+		trace << (firstEvent ? "\n\t" : ",\n\t") << event;
+		firstEvent = false;
+	};
+
+	trace << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+
+	std::lock_guard<std::mutex> lock(ringsLock);
+	std::vector<ProfileEvent> events;
+
+	for(auto& ring : rings)
+	{
+		snprintf(line, sizeof(line), "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+			ring->ThreadIndex, ring->ThreadName.c_str());
+		writeEvent(line);
+
+		unsigned long long end = ring->Head.load(std::memory_order_acquire);
+		unsigned long long begin = end > EventCapacity ? end - EventCapacity : 0;
+
+		events.clear();
+		for(unsigned long long i = begin; i < end; i++)
+		{
+			events.push_back(ring->Events[i % EventCapacity]);
+		}
+
+		// The owner kept recording while copying, the slot it is writing & everything before it could be torn //
+		unsigned long long head = ring->Head.load(std::memory_order_acquire);
+		unsigned long long firstIntact = head >= EventCapacity ? head - EventCapacity + 1 : 0;
+
+		for(unsigned long long i = begin; i < end; i++)
+		{
+			if(i < firstIntact)
+			{
+				continue;
+			}
+
+			const ProfileEvent& event = events[i - begin];
+			snprintf(line, sizeof(line), "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %lld.%03lld, \"dur\": %lld.%03lld}",
+				event.Name, ring->ThreadIndex, event.Start / 1000, event.Start % 1000, event.Duration / 1000, event.Duration % 1000);
+			writeEvent(line);
+		}
+	}
+
+	trace << "\n]}\n";
+	return trace.good();
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+
+// Records the zones of 'PROFILE_ZONE', set to false to compile them away //
+#ifndef USE_PROFILER
+#define USE_PROFILER true
+#endif
+
+/// <summary>
+/// Low-overhead profiler for diagnosing frame stalls offline. Every thread records its zones into
+/// its own ring of the last 'EventCapacity' events, without locks or allocations, so it can stay on
+/// all the time. 'WriteChromeTrace' dumps whatever is in the rings in the Chrome trace event format,
+/// which both chrome://tracing and ui.perfetto.dev can open.
+/// </summary>
+class Profiler
+{
+public:
+	// Nanoseconds since the profiler got started //
+	static long long Now();
+
+	static void RecordZone(const char* name, long long start, long long end);
+
+	// Shown as the name of the calling thread its track //
+	static void SetThreadName(const std::string& name);
+
+	// Returns false if 'path' couldn't be written //
+	static bool WriteChromeTrace(const std::string& path);
+
+	static const unsigned int EventCapacity = 16384;
+};
+
+/// <summary>
+/// Records the scope it lives in as a zone. 'name' isn't copied, so it has to
+/// stay alive for as long as the profiler does, like a string literal.
+/// </summary>
+class ProfileZone
+{
+public:
+	ProfileZone(const char* name) : name(name), start(Profiler::Now()) {}
+	~ProfileZone() { Profiler::RecordZone(name, start, Profiler::Now()); }
+
+private:
+	const char* name;
+	long long start;
+};
+
+// Profiles the rest of the current scope, e.g. PROFILE_ZONE("Post Process") //
+#if USE_PROFILER
+#define PROFILE_ZONE_NAME(line) profileZone##line
+#define PROFILE_ZONE_LINE(name, line) ProfileZone PROFILE_ZONE_NAME(line)(name)
+#define PROFILE_ZONE(name) PROFILE_ZONE_LINE(name, __LINE__)
+#else
+#define PROFILE_ZONE(name)
+#endif
@@ -1,26 +1,26 @@
 #include "Timer.h"
 #include "LogHelper.h"
 
-Timer::Timer(int logSize, std::string name) : logSize(logSize), name(name)
+Timer::Timer(int logSize, std::string name) : logs(logSize, 0.0f), logSize(logSize), name(name)
 {
-	logs = new float[logSize];
 }
 
 void Timer::Start(bool printAverage, bool printTotalTimeLasped)
 {
-	memset(logs, 0.0f, sizeof(float) * logSize);
+	logs.assign(logSize, 0.0f);
 
 	currentLogIndex = 0;
 	logAverageToConsole = printAverage;
 	logTotalToConsole = printTotalTimeLasped;
 
-	t0 = std::chrono::time_point_cast<std::chrono::milliseconds>((clock.now())).time_since_epoch();
+	t0 = std::chrono::high_resolution_clock::now();
 	running = true;
+	stopped = false;
 }
 
 void Timer::Stop()
 {
-	stopped = false;
+	stopped = true;
 }
 
 float Timer::Log(bool printResult)
@@ -36,8 +36,8 @@ float Timer::Log(bool printResult)
 		return 0.0f;
 	}
 
-	t1 = std::chrono::time_point_cast<std::chrono::milliseconds>((clock.now())).time_since_epoch();
-	float timeElapsed = (t1 - t0).count() * .001;
+	auto t1 = std::chrono::high_resolution_clock::now();
+	float timeElapsed = std::chrono::duration<float>(t1 - t0).count();
 	logs[currentLogIndex] = timeElapsed;
 	t0 = t1;
 	currentLogIndex++;
@@ -70,6 +70,8 @@ float Timer::Log(bool printResult)
 			LOG(msg);
 		}
 	}
+
+	return timeElapsed;
 }
 
 float Timer::GetAverage()
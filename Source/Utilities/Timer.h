@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <string>
+#include <vector>
 
 class Timer
 {
@@ -11,18 +12,17 @@ public:
 	void Start(bool printAverage = false, bool printTotalTimeLasped = false);
 	void Stop();
 
+	// Seconds since the last 'Log' or 'Start' //
 	float Log(bool printResult = false);
 	float GetAverage();
 	float GetTotalLoggedTime();
 
 private:
-	std::chrono::high_resolution_clock clock;
-	std::chrono::duration<long long, std::milli> t0;
-	std::chrono::duration<long long, std::milli> t1;
+	std::chrono::high_resolution_clock::time_point t0;
 
-	float* logs;
+	std::vector<float> logs;
 	int logSize;
-	int currentLogIndex;
+	int currentLogIndex = 0;
 
 	bool running = false;
 	bool stopped = false;
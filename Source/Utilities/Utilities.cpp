@@ -1,4 +1,5 @@
 #include "Utilities.h"
+#include <cstring>
 
 void ClearBuffer(unsigned int* buffer, unsigned int color, unsigned int elementCount)
 {
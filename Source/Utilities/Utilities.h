@@ -6,14 +6,41 @@
 #include "LogHelper.h"
 #include <iostream>
 
+// Builds without GLFW, OpenGL & ImGui, for machines without a display.
+// Only batch rendering is available then, see 'BatchRenderer'. Set from the build system.
+#ifndef ACADEMIA_HEADLESS
+#define ACADEMIA_HEADLESS false
+#endif
+
 void ClearBuffer(unsigned int* buffer, unsigned int color, unsigned int elementCount);
 unsigned int AlbedoToRGB(float r, float g, float b);
 
 int Clamp(int v, int min, int max);
 float Clamp(float v, float min, float max);
 
-static unsigned int state = time(NULL);
-inline unsigned int xorshift32()
+// Random Number Generation //
+// There is no global RNG state, every path carries its own 'seed' around.
+// This prevents worker threads from racing on (and sharing a cache line for) one state,
+// and makes renders reproducible, since a seed only depends on pixel, sample & global seed.
+inline unsigned int WangHash(unsigned int seed)
+{
+	seed = (seed ^ 61) ^ (seed >> 16);
+	seed *= 9;
+	seed = seed ^ (seed >> 4);
+	seed *= 0x27d4eb2d;
+	seed = seed ^ (seed >> 15);
+	return seed;
+}
+
+inline unsigned int CreateSeed(unsigned int pixelX, unsigned int pixelY, unsigned int sampleIndex, unsigned int globalSeed)
+{
+	unsigned int seed = WangHash(pixelX ^ WangHash(pixelY ^ WangHash(sampleIndex ^ WangHash(globalSeed))));
+
+	// xorshift gets stuck on 0 //
+	return seed != 0 ? seed : 1;
+}
+
+inline unsigned int xorshift32(unsigned int& state)
 {
 	state ^= state << 13;
 	state ^= state >> 17;
@@ -21,14 +48,14 @@ inline unsigned int xorshift32()
 	return state;
 }
 
-inline float Random01()
+inline float Random01(unsigned int& seed)
 {
-	return xorshift32() * 2.3283064365387e-10f;
+	return xorshift32(seed) * 2.3283064365387e-10f;
 }
 
-inline float RandomInRange(float min, float max)
+inline float RandomInRange(float min, float max, unsigned int& seed)
 {
-	return min + (max - min) * Random01();
+	return min + (max - min) * Random01(seed);
 }
 
 inline float Lerp(float a, float b, float t)
@@ -1,9 +1,55 @@
+#include "Framework/BatchRenderer.h"
+#include "Framework/Benchmark.h"
+#include "Utilities/Utilities.h"
+#include "Utilities/Profiler.h"
+
+#if !ACADEMIA_HEADLESS
 #include "Framework/App.h"
+#endif
 
-int main()
+int main(int argc, char** argv)
 {
+	Profiler::SetThreadName("Main");
+
+	// Renders straight to disk, e.g. 'Academia --batch Scenes/Default.scene --spp 1024' //
+	BatchSettings batchSettings;
+	if(ParseBatchArguments(argc, argv, batchSettings))
+	{
+		bool succeeded;
+
+		if(batchSettings.Benchmark)
+		{
+			succeeded = RunBenchmark(batchSettings);
+		}
+		else
+		{
+			BatchRenderer batchRenderer(batchSettings);
+			succeeded = batchRenderer.Render();
+		}
+
+		if(!batchSettings.ProfilePath.empty())
+		{
+			if(Profiler::WriteChromeTrace(batchSettings.ProfilePath))
+			{
+				LOG("Profile written to '" + batchSettings.ProfilePath + "'");
+			}
+			else
+			{
+				LOG(Log::MessageType::Error, "Failed to write '" + batchSettings.ProfilePath + "'");
+				succeeded = false;
+			}
+		}
+
+		return succeeded ? 0 : 1;
+	}
+
+#if ACADEMIA_HEADLESS
+	LOG(Log::MessageType::Error, "Headless builds can only batch render, pass '--batch <scene>' or '--benchmark'.");
+	return 1;
+#else
 	App application;
 	application.Run();
 
 	return 0;
-}
\ No newline at end of file
+#endif
+}